@@ -0,0 +1,107 @@
+#ifndef ESP_REFLEX_APP_ALIAS_TABLE_HPP
+#define ESP_REFLEX_APP_ALIAS_TABLE_HPP
+
+#include "app_random.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace app {
+
+/**
+ * @brief Draws indices with fixed integer weights in constant time.
+ *
+ * Vose's alias method: every column keeps its own index below a threshold and
+ * hands the rest of its share to one alias, so a draw is one column pick and
+ * one comparison no matter how skewed the weights are. Building the table is
+ * linear and exact in integers.
+ */
+template<size_t Size>
+class AliasTable {
+  static_assert(Size > 0 && Size <= 256, "Indices must fit into a byte");
+
+public:
+  using Weights = std::array<uint32_t, Size>;
+
+  AliasTable() noexcept {
+    build({});
+  }
+
+  /**
+   * @brief Rebuilds the table, an index is drawn with probability weight /
+   * sum of all weights. A weight of 0 is never drawn, all weights 0 draw
+   * uniformly.
+   *
+   * @param weights The weights, their sum must fit into 32 bits.
+   */
+  void build(const Weights& weights) noexcept {
+    uint64_t total = 0;
+    for (const uint32_t weight : weights) {
+      total += weight;
+    }
+
+    // Every column holds a share of `total`, scaled by Size to stay integer
+    std::array<uint64_t, Size> shares = {};
+    for (size_t i = 0; i < Size; ++i) {
+      shares[i] = total > 0 ? uint64_t {weights[i]} * Size : 1;
+    }
+    if (total == 0) {
+      total = Size;
+    }
+
+    std::array<uint8_t, Size> small       = {};
+    std::array<uint8_t, Size> large       = {};
+    size_t                    small_count = 0;
+    size_t                    large_count = 0;
+    for (size_t i = 0; i < Size; ++i) {
+      if (shares[i] < total) {
+        small[small_count++] = static_cast<uint8_t>(i);
+      } else {
+        large[large_count++] = static_cast<uint8_t>(i);
+      }
+    }
+
+    while (small_count > 0 && large_count > 0) {
+      const uint8_t less = small[--small_count];
+      const uint8_t more = large[large_count - 1];
+
+      m_thresholds[less] = static_cast<uint32_t>(shares[less]);
+      m_aliases[less]    = more;
+
+      shares[more] -= total - shares[less];
+      if (shares[more] < total) {
+        --large_count;
+        small[small_count++] = more;
+      }
+    }
+
+    // Whatever is left fills its column exactly
+    for (size_t i = 0; i < large_count; ++i) {
+      m_thresholds[large[i]] = static_cast<uint32_t>(total);
+      m_aliases[large[i]]    = large[i];
+    }
+    for (size_t i = 0; i < small_count; ++i) {
+      m_thresholds[small[i]] = static_cast<uint32_t>(total);
+      m_aliases[small[i]]    = small[i];
+    }
+
+    m_total = static_cast<uint32_t>(total);
+  }
+
+  [[nodiscard]] uint8_t sample(Random& random) const noexcept {
+    const uint32_t column = random.below(Size);
+    return random.below(m_total) < m_thresholds[column]
+           ? static_cast<uint8_t>(column)
+           : m_aliases[column];
+  }
+
+private:
+  std::array<uint32_t, Size> m_thresholds = {};
+  std::array<uint8_t, Size>  m_aliases    = {};
+  uint32_t                   m_total      = 0;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_ALIAS_TABLE_HPP
@@ -0,0 +1,330 @@
+#ifndef ESP_REFLEX_APP_APPEND_LOG_HPP
+#define ESP_REFLEX_APP_APPEND_LOG_HPP
+
+#include "app_crc32.hpp"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace app {
+
+/**
+ * @brief What a log needs from its flash: sectors erased to all ones, writes
+ * that only clear bits, reads anywhere.
+ */
+template<typename Storage>
+concept LogStorage =
+requires(Storage&                       storage,
+         const Storage&                 const_storage,
+         const size_t                   offset,
+         const std::span<uint8_t>       out,
+         const std::span<const uint8_t> in) {
+  { Storage::sector_size } -> std::convertible_to<size_t>;
+  { const_storage.sector_count() } noexcept -> std::same_as<size_t>;
+  { storage.read(offset, out) } noexcept -> std::same_as<bool>;
+  { storage.write(offset, in) } noexcept -> std::same_as<bool>;
+  { storage.erase(offset) } noexcept -> std::same_as<bool>;
+};
+
+/**
+ * @brief Append only log of fixed size entries in a ring of flash sectors.
+ *
+ * Every entry is written once into the next free slot of the current sector
+ * with a sequence number and a CRC, so an interrupted write is recognised and
+ * skipped. The first slot of a sector holds its generation, the sector with
+ * the highest one is the current sector and the sector after it is always
+ * kept erased. When the current sector is full the log moves on to that
+ * sector, copies the entries the owner still needs out of the sector after it
+ * and erases it. Every sector is erased once per turn of the ring, so the
+ * wear is spread evenly and bounded by the rate of appends.
+ *
+ * An entry keeps its sequence number when it is copied, a copy left behind by
+ * an interrupted compaction is reported again with the same number.
+ *
+ * @tparam Entry A trivially copyable entry.
+ * @tparam Storage The flash, see `LogStorage`, at least two sectors.
+ */
+template<typename Entry, LogStorage Storage>
+class AppendLog {
+  static_assert(std::is_trivially_copyable_v<Entry>);
+
+  static constexpr size_t slot_size =
+  (2 * sizeof(uint32_t) + sizeof(Entry) + 3) / 4 * 4;
+
+public:
+  // Entries in one sector, the most a compaction may need to keep
+  static constexpr size_t sector_entries = Storage::sector_size / slot_size - 1;
+
+  static_assert(sector_entries > 0, "An entry must fit into a sector");
+
+  explicit AppendLog(Storage& storage) noexcept : m_storage(storage) {}
+
+  // Sequence number the next appended entry gets
+  [[nodiscard]] uint32_t get_next_sequence() const noexcept {
+    return m_next_sequence;
+  }
+
+  /**
+   * @brief Scans the whole log and prepares it for appending.
+   *
+   * @param on_entry Called with the sequence number and the entry of every
+   * intact entry, in no particular order.
+   * @return False if the storage failed or has less than two sectors.
+   */
+  template<typename OnEntry>
+  [[nodiscard]] bool load(OnEntry&& on_entry) noexcept {
+    const size_t count = m_storage.sector_count();
+    if (count < 2) {
+      return false;
+    }
+
+    bool     found        = false;
+    uint32_t max_sequence = 0;
+    for (size_t sector = 0; sector < count; ++sector) {
+      Slot slot = {};
+      if (!read_slot(sector, 0, slot)) {
+        return false;
+      }
+
+      uint32_t generation = 0;
+      Entry    header     = {};
+      if (decode(slot, generation, header) &&
+          (!found || generation > m_generation)) {
+        found        = true;
+        m_generation = generation;
+        m_current    = sector;
+      }
+
+      const bool scanned =
+      for_each_slot(sector, [&](size_t /*index*/, const Slot& entry_slot) {
+        uint32_t sequence = 0;
+        Entry    entry    = {};
+        if (decode(entry_slot, sequence, entry)) {
+          max_sequence = std::max(max_sequence, sequence);
+          on_entry(sequence, entry);
+        }
+      });
+      if (!scanned) {
+        return false;
+      }
+    }
+    m_next_sequence = max_sequence + 1;
+
+    // A log without any valid sector starts over in the first one
+    if (!found) {
+      for (size_t sector = 0; sector < count; ++sector) {
+        if (!is_blank(sector) && !m_storage.erase(sector)) {
+          return false;
+        }
+      }
+      m_current    = 0;
+      m_generation = 1;
+      m_pending    = false;
+      m_write      = 1;
+      return write_slot(m_current, 0, m_generation, {});
+    }
+
+    // The current sector fills up to the last slot that was ever written
+    m_write = 1;
+    const bool scanned =
+    for_each_slot(m_current, [this](const size_t index, const Slot& slot) {
+      if (!is_blank(slot)) {
+        m_write = index + 1;
+      }
+    });
+
+    // The erase of a compaction did not finish
+    m_pending = !is_blank(get_next(m_current));
+    return scanned;
+  }
+
+  /**
+   * @brief Appends an entry.
+   *
+   * @param entry The entry.
+   * @param is_live Called with the sequence number and the entry of every
+   * entry of a sector that is about to be erased, the entries it keeps are
+   * copied into the current sector. Must keep fewer than `sector_entries`.
+   * @return False if the storage failed.
+   */
+  template<typename IsLive>
+  [[nodiscard]] bool append(const Entry& entry, IsLive&& is_live) noexcept {
+    if (m_pending && !compact(get_next(m_current), is_live)) {
+      return false;
+    }
+
+    if (m_write > sector_entries) {
+      const size_t next = get_next(m_current);
+      if (!write_slot(next, 0, m_generation + 1, {})) {
+        return false;
+      }
+
+      m_current = next;
+      m_write   = 1;
+      ++m_generation;
+      if (!compact(get_next(m_current), is_live)) {
+        return false;
+      }
+    }
+
+    return write_slot(m_current, m_write++, m_next_sequence++, entry);
+  }
+
+private:
+  using Slot = std::array<uint8_t, slot_size>;
+
+  // Slots read at once while scanning a sector
+  static constexpr size_t chunk_slots = 16;
+
+  [[nodiscard]] size_t get_next(const size_t sector) const noexcept {
+    return (sector + 1) % m_storage.sector_count();
+  }
+
+  [[nodiscard]] static constexpr size_t
+  get_offset(const size_t sector, const size_t index) noexcept {
+    return sector * Storage::sector_size + index * slot_size;
+  }
+
+  [[nodiscard]] static bool is_blank(const Slot& slot) noexcept {
+    return std::ranges::all_of(slot, [](const uint8_t byte) noexcept {
+      return byte == 0xFF;
+    });
+  }
+
+  [[nodiscard]] bool is_blank(const size_t sector) noexcept {
+    Slot header = {};
+    bool blank  = read_slot(sector, 0, header) && is_blank(header);
+
+    const bool scanned =
+    for_each_slot(sector, [&blank](size_t /*index*/, const Slot& slot) {
+      blank = blank && is_blank(slot);
+    });
+    return scanned && blank;
+  }
+
+  // Sequence number, entry and the CRC of both
+  [[nodiscard]] static Slot encode(const uint32_t sequence,
+                                   const Entry&   entry) noexcept {
+    Slot slot = {};
+    std::memcpy(slot.data(), &sequence, sizeof(sequence));
+    std::memcpy(slot.data() + sizeof(sequence), &entry, sizeof(Entry));
+
+    const size_t   size = sizeof(sequence) + sizeof(Entry);
+    const uint32_t crc  = crc32(std::span(slot).first(size));
+    std::memcpy(slot.data() + size, &crc, sizeof(crc));
+    return slot;
+  }
+
+  [[nodiscard]] static bool
+  decode(const Slot& slot, uint32_t& sequence, Entry& entry) noexcept {
+    const size_t size = sizeof(sequence) + sizeof(Entry);
+    uint32_t     crc  = 0;
+    std::memcpy(&crc, slot.data() + size, sizeof(crc));
+    if (is_blank(slot) || crc != crc32(std::span(slot).first(size))) {
+      return false;
+    }
+
+    std::memcpy(&sequence, slot.data(), sizeof(sequence));
+    std::memcpy(&entry, slot.data() + sizeof(sequence), sizeof(Entry));
+    return true;
+  }
+
+  [[nodiscard]] bool read_slot(const size_t sector,
+                               const size_t index,
+                               Slot&        slot) noexcept {
+    return m_storage.read(get_offset(sector, index), slot);
+  }
+
+  [[nodiscard]] bool write_slot(const size_t   sector,
+                                const size_t   index,
+                                const uint32_t sequence,
+                                const Entry&   entry) noexcept {
+    const Slot slot = encode(sequence, entry);
+    return m_storage.write(get_offset(sector, index), slot);
+  }
+
+  /**
+   * @brief Calls `on_slot` with the index and the content of every entry slot
+   * of a sector, reading a chunk of slots at once.
+   */
+  template<typename OnSlot>
+  [[nodiscard]] bool for_each_slot(const size_t sector,
+                                   OnSlot&&     on_slot) noexcept {
+    std::array<uint8_t, chunk_slots * slot_size> chunk = {};
+
+    for (size_t first = 1; first <= sector_entries; first += chunk_slots) {
+      const size_t count = std::min(chunk_slots, sector_entries + 1 - first);
+      if (!m_storage.read(get_offset(sector, first),
+                          std::span(chunk).first(count * slot_size))) {
+        return false;
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+        Slot slot = {};
+        std::memcpy(slot.data(), chunk.data() + i * slot_size, slot_size);
+        on_slot(first + i, slot);
+      }
+    }
+    return true;
+  }
+
+  [[nodiscard]] bool contains(const size_t   sector,
+                              const uint32_t sequence) noexcept {
+    for (size_t index = 1; index < m_write; ++index) {
+      Slot     slot  = {};
+      uint32_t found = 0;
+      Entry    entry = {};
+      if (read_slot(sector, index, slot) && decode(slot, found, entry) &&
+          found == sequence) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Copies the live entries of a sector into the current sector and
+   * erases it.
+   */
+  template<typename IsLive>
+  [[nodiscard]] bool compact(const size_t sector, IsLive& is_live) noexcept {
+    for (size_t index = 1; index <= sector_entries; ++index) {
+      Slot     slot     = {};
+      uint32_t sequence = 0;
+      Entry    entry    = {};
+      if (!read_slot(sector, index, slot)) {
+        return false;
+      }
+      if (!decode(slot, sequence, entry) ||
+          !is_live(sequence, entry) ||
+          contains(m_current, sequence)) {
+        continue;
+      }
+
+      if (m_write > sector_entries ||
+          !write_slot(m_current, m_write++, sequence, entry)) {
+        return false;
+      }
+    }
+
+    m_pending = false;
+    return m_storage.erase(sector);
+  }
+
+  Storage& m_storage;
+  size_t   m_current       = 0;
+  size_t   m_write         = 1;
+  uint32_t m_generation    = 0;
+  uint32_t m_next_sequence = 1;
+  bool     m_pending       = false;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_APPEND_LOG_HPP
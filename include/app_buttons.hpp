@@ -0,0 +1,143 @@
+#ifndef ESP_REFLEX_APP_BUTTONS_HPP
+#define ESP_REFLEX_APP_BUTTONS_HPP
+
+#include "config.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Compile time table from button id to the meaning of the button on it, so
+// classifying a press is a single load for any number of stations. The ids 0
+// to 39 are the native GPIOs, the pins of the button MCP23017 follow them.
+
+namespace app::buttons {
+
+// The ESP32 has GPIO 0 to 39
+constexpr inline size_t gpio_count = 40;
+
+// Ports A and B of the button MCP23017
+constexpr inline size_t expander_pin_count = 16;
+
+constexpr inline size_t id_count = gpio_count + expander_pin_count;
+
+static_assert(config::mcp::buttons_first_id == gpio_count,
+              "The expander ids follow the GPIO numbers");
+
+enum class Kind : uint8_t {
+  None,
+  Start,
+  Player
+};
+
+struct Button {
+  Kind    kind;
+  uint8_t player;    // station index, only for Player buttons
+  uint8_t target;    // target index within the station, only for Player buttons
+};
+
+namespace impl {
+
+// Pins that are wired to something else and must never be a button
+constexpr inline std::array<uint8_t, 4> reserved_pins = {
+  config::gpio::start_out,
+  config::gpio::buttons_int,
+  config::i2c::i2c_sda,
+  config::i2c::i2c_scl};
+
+/**
+ * @brief Returns true if every button has a valid id, no id carries two
+ * buttons, the start button is native and no button sits on a reserved pin.
+ */
+[[nodiscard]] constexpr bool is_valid() noexcept {
+  std::array<uint8_t, id_count> uses = {};
+
+  const auto use = [&uses](const uint8_t id) noexcept {
+    if (id < id_count) {
+      ++uses[id];
+    }
+    return id < id_count;
+  };
+
+  bool valid = config::gpio::start_in < gpio_count &&
+               use(config::gpio::start_in);
+  for (const auto& station : config::stations::stations) {
+    for (const uint8_t id : station.buttons_in) {
+      valid = use(id) && valid;
+    }
+  }
+
+  for (const uint8_t pin : reserved_pins) {
+    if (pin < gpio_count && uses[pin] > 0) {
+      return false;
+    }
+  }
+  for (const uint8_t count : uses) {
+    if (count > 1) {
+      return false;
+    }
+  }
+
+  return valid;
+}
+
+static_assert(is_valid(), "Duplicate, reserved or invalid button id");
+
+[[nodiscard]] constexpr std::array<Button, id_count> make_table() noexcept {
+  std::array<Button, id_count> table = {};
+
+  table[config::gpio::start_in] = {Kind::Start, 0, 0};
+
+  const auto& stations = config::stations::stations;
+  for (size_t player = 0; player < stations.size(); ++player) {
+    const auto& buttons = stations[player].buttons_in;
+    for (size_t target = 0; target < buttons.size(); ++target) {
+      table[buttons[target]] = {Kind::Player,
+                                static_cast<uint8_t>(player),
+                                static_cast<uint8_t>(target)};
+    }
+  }
+
+  return table;
+}
+
+constexpr inline std::array<Button, id_count> table = make_table();
+
+}    // namespace impl
+
+/**
+ * @brief Returns what the button with an id is, `Kind::None` for any id
+ * without a button.
+ */
+[[nodiscard]] constexpr Button classify(const uint8_t id) noexcept {
+  return id < id_count ? impl::table[id] : Button {};
+}
+
+/**
+ * @brief Returns true if the button id is a native GPIO, false for a pin of
+ * the button MCP23017.
+ */
+[[nodiscard]] constexpr bool is_native(const uint8_t id) noexcept {
+  return id < gpio_count;
+}
+
+// The number of player buttons on native GPIOs, the others are on the
+// expander
+constexpr inline size_t native_player_count = [] {
+  size_t count = 0;
+  for (const auto& station : config::stations::stations) {
+    for (const uint8_t id : station.buttons_in) {
+      count += is_native(id) ? 1U : 0U;
+    }
+  }
+  return count;
+}();
+
+// Whether the button MCP23017 has to be read at all
+constexpr inline bool uses_expander =
+native_player_count <
+config::stations::stations.size() * config::stations::targets_per_station;
+
+}    // namespace app::buttons
+
+#endif    //ESP_REFLEX_APP_BUTTONS_HPP
@@ -19,10 +19,12 @@ struct PlayerPins {
 
 void turn_on(const uint8_t pin, Output output) noexcept;
 void turn_off(const uint8_t pin, Output output) noexcept;
+void write_port(uint16_t value, Output output) noexcept;
 void turn_on_row(Player player, Row row) noexcept;
 void turn_off_row(Player player, Row row) noexcept;
 void all_off() noexcept;
 void display_segment_number(uint8_t number, SegmentDisplay display) noexcept;
+void display_segment_tenths(uint16_t tenths, SegmentDisplay display) noexcept;
 void turn_off_segment(SegmentDisplay display) noexcept;
 
 }    // namespace gpio
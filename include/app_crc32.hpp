@@ -0,0 +1,30 @@
+#ifndef ESP_REFLEX_APP_CRC32_HPP
+#define ESP_REFLEX_APP_CRC32_HPP
+
+#include <cstdint>
+#include <span>
+
+namespace app {
+
+/**
+ * @brief CRC-32 as in zlib, bitwise with the reflected polynomial.
+ *
+ * @param data The bytes.
+ * @param crc The CRC of the bytes before, so a long record can be checked in
+ * chunks: crc32(b, crc32(a)) is the CRC of a followed by b.
+ */
+[[nodiscard]] constexpr uint32_t crc32(const std::span<const uint8_t> data,
+                                       uint32_t crc = 0) noexcept {
+  crc = ~crc;
+  for (const uint8_t byte : data) {
+    crc ^= byte;
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1U) ^ (0xEDB8'8320U & (0U - (crc & 1U)));
+    }
+  }
+  return ~crc;
+}
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_CRC32_HPP
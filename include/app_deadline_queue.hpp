@@ -0,0 +1,105 @@
+#ifndef ESP_REFLEX_APP_DEADLINE_QUEUE_HPP
+#define ESP_REFLEX_APP_DEADLINE_QUEUE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace app {
+
+template<typename Kind>
+struct Deadline {
+  int64_t due_us;
+  Kind    kind;
+};
+
+/**
+ * @brief Fixed capacity min-heap of deadlines, earliest deadline on top.
+ *
+ * Holds every timed event of a game so a single one-shot timer armed to
+ * `top()` is enough to wake the game loop for all of them.
+ */
+template<typename Kind, size_t Capacity>
+class DeadlineQueue {
+public:
+  [[nodiscard]] bool empty() const noexcept {
+    return m_size == 0;
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return m_size;
+  }
+
+  [[nodiscard]] const Deadline<Kind>& top() const noexcept {
+    return m_heap[0];
+  }
+
+  void clear() noexcept {
+    m_size = 0;
+  }
+
+  /**
+   * @brief Adds a deadline.
+   *
+   * @return false if the queue is full and the deadline was not added.
+   */
+  [[nodiscard]] bool push(const int64_t due_us, const Kind kind) noexcept {
+    if (m_size == Capacity) {
+      return false;
+    }
+
+    size_t index  = m_size++;
+    m_heap[index] = {due_us, kind};
+
+    while (index > 0) {
+      const size_t parent = (index - 1) / 2;
+      if (m_heap[parent].due_us <= m_heap[index].due_us) {
+        break;
+      }
+      std::swap(m_heap[parent], m_heap[index]);
+      index = parent;
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Removes and returns the earliest deadline, the queue must not be
+   * empty.
+   */
+  Deadline<Kind> pop() noexcept {
+    const Deadline<Kind> earliest = m_heap[0];
+    m_heap[0]                     = m_heap[--m_size];
+
+    size_t index = 0;
+    while (true) {
+      const size_t left     = 2 * index + 1;
+      const size_t right    = left + 1;
+      size_t       smallest = index;
+
+      if (left < m_size && m_heap[left].due_us < m_heap[smallest].due_us) {
+        smallest = left;
+      }
+      if (right < m_size && m_heap[right].due_us < m_heap[smallest].due_us) {
+        smallest = right;
+      }
+      if (smallest == index) {
+        break;
+      }
+
+      std::swap(m_heap[smallest], m_heap[index]);
+      index = smallest;
+    }
+
+    return earliest;
+  }
+
+private:
+  std::array<Deadline<Kind>, Capacity> m_heap = {};
+  size_t                               m_size = 0;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_DEADLINE_QUEUE_HPP
@@ -0,0 +1,108 @@
+#ifndef ESP_REFLEX_APP_FILE_STORAGE_HPP
+#define ESP_REFLEX_APP_FILE_STORAGE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+// Host stand-in for a flash partition, so the logs that live in flash on the
+// ESP32 run and can be measured on a host. Not built into the firmware.
+
+namespace app {
+
+/**
+ * @brief `LogStorage` in a file, with the semantics of NOR flash.
+ *
+ * Erased bytes read as 0xFF and a write only clears bits, like the SPI flash
+ * of the ESP32, so code that runs against it runs against the partition.
+ */
+class FileStorage {
+public:
+  static constexpr size_t sector_size = 4096;
+
+  /**
+   * @brief Opens the file, creates it erased if it does not exist.
+   */
+  FileStorage(const char* path, const size_t sector_count) noexcept
+  : m_sector_count(sector_count) {
+    m_file = std::fopen(path, "r+b");
+    if (m_file != nullptr) {
+      return;
+    }
+
+    m_file = std::fopen(path, "w+b");
+    for (size_t sector = 0; m_file != nullptr && sector < sector_count;
+         ++sector) {
+      static_cast<void>(erase(sector));
+    }
+  }
+
+  FileStorage(const FileStorage&)            = delete;
+  FileStorage& operator=(const FileStorage&) = delete;
+
+  ~FileStorage() noexcept {
+    if (m_file != nullptr) {
+      std::fclose(m_file);
+    }
+  }
+
+  [[nodiscard]] size_t sector_count() const noexcept {
+    return m_file != nullptr ? m_sector_count : 0;
+  }
+
+  [[nodiscard]] bool read(const size_t             offset,
+                          const std::span<uint8_t> data) noexcept {
+    return seek(offset, data.size()) &&
+           std::fread(data.data(), 1, data.size(), m_file) == data.size();
+  }
+
+  [[nodiscard]] bool write(const size_t                   offset,
+                           const std::span<const uint8_t> data) noexcept {
+    std::array<uint8_t, sector_size> current = {};
+
+    for (size_t done = 0; done < data.size(); done += current.size()) {
+      const std::span<const uint8_t> part = data.subspan(done).first(
+      std::min(current.size(), data.size() - done));
+      const std::span<uint8_t> old = std::span(current).first(part.size());
+      if (!read(offset + done, old)) {
+        return false;
+      }
+
+      for (size_t i = 0; i < part.size(); ++i) {
+        old[i] &= part[i];
+      }
+      if (!seek(offset + done, old.size()) ||
+          std::fwrite(old.data(), 1, old.size(), m_file) != old.size()) {
+        return false;
+      }
+    }
+
+    return std::fflush(m_file) == 0;
+  }
+
+  [[nodiscard]] bool erase(const size_t sector) noexcept {
+    std::array<uint8_t, sector_size> erased = {};
+    erased.fill(0xFF);
+
+    return seek(sector * sector_size, sector_size) &&
+           std::fwrite(erased.data(), 1, erased.size(), m_file) ==
+           erased.size() &&
+           std::fflush(m_file) == 0;
+  }
+
+private:
+  [[nodiscard]] bool seek(const size_t offset, const size_t size) noexcept {
+    return m_file != nullptr && offset + size <= m_sector_count * sector_size &&
+           std::fseek(m_file, static_cast<long>(offset), SEEK_SET) == 0;
+  }
+
+  std::FILE* m_file         = nullptr;
+  size_t     m_sector_count = 0;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_FILE_STORAGE_HPP
@@ -1,29 +1,51 @@
 #ifndef ESP_REFLEX_APP_GAME_HPP
 #define ESP_REFLEX_APP_GAME_HPP
 
+#include "app_histogram.hpp"
+#include "app_history_codec.hpp"
+#include "config.hpp"
+
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 
 // todo: isrs for buttons, receiving queue from isr, game logic, led output
 // todo: ensure that when player reaches 99 points the game ends
 
 namespace app::game {
 
-struct FinalScore {
-  uint8_t player1;
-  uint8_t player2;
-};
+// Target index reported by `get_current_targets` while no game is running
+constexpr inline uint8_t no_target = std::numeric_limits<uint8_t>::max();
 
-void wait_for_start_press() noexcept;
-void play() noexcept;
+// One entry per station
+using FinalScore = std::array<uint8_t, config::stations::stations.size()>;
+using Targets    = std::array<uint8_t, config::stations::stations.size()>;
 
-[[nodiscard]] FinalScore get_last_final_score() noexcept;
+struct ReactionStats {
+  uint32_t hits;
+  uint32_t min_us;
+  uint32_t mean_us;
+  uint32_t stddev_us;
+  uint32_t p50_us;
+  uint32_t p95_us;
+};
 
-//  static void attach_isr_gpio() noexcept;
-//  static void detach_isr_gpio() noexcept;
-//
-//  static void IRAM_ATTR isr_gpio(void* arg) noexcept;
-//
-//  QueueHandle_t m_queue_gpio_input;
+void               wait_for_start_press() noexcept;
+void               prepare(int64_t go_us) noexcept;
+[[nodiscard]] bool resume() noexcept;
+void               play() noexcept;
+void               report() noexcept;
+
+[[nodiscard]] FinalScore       get_last_final_score() noexcept;
+[[nodiscard]] Targets          get_current_targets() noexcept;
+[[nodiscard]] LatencyHistogram get_last_service_latency() noexcept;
+[[nodiscard]] LatencyHistogram get_last_expiry_jitter() noexcept;
+[[nodiscard]] int64_t          get_last_lit_us() noexcept;
+[[nodiscard]] int64_t          get_last_end_us() noexcept;
+[[nodiscard]] ReactionStats    get_last_reaction_stats(size_t player) noexcept;
+
+[[nodiscard]] const history::Game& get_last_history() noexcept;
 
 }    // namespace app::game
 
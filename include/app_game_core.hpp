@@ -0,0 +1,231 @@
+#ifndef ESP_REFLEX_APP_GAME_CORE_HPP
+#define ESP_REFLEX_APP_GAME_CORE_HPP
+
+#include "app_alias_table.hpp"
+#include "app_deadline_queue.hpp"
+#include "app_random.hpp"
+#include "app_timer_wheel.hpp"
+#include "config.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Hardware free rules of the game. The firmware translates button presses and
+// the passing of time into events, `step` turns them into actions that the
+// firmware commits to the outputs. Nothing in here touches a peripheral, so the
+// core also builds and runs on a host.
+
+namespace app::game::core {
+
+constexpr inline size_t  player_count = config::stations::stations.size();
+constexpr inline size_t  target_count = config::stations::targets_per_station;
+constexpr inline int64_t second_us    = 1'000'000;
+constexpr inline int64_t tenth_us     = second_us / 10;
+
+enum class DeadlineKind : uint8_t {
+  ClockTick,
+  GameEnd
+};
+
+using Deadlines = DeadlineQueue<DeadlineKind, config::game::max_deadlines>;
+
+// One expiry per lit target, tagged with the player
+using Expiries =
+TimerWheel<player_count * target_count, config::game::expiry_tick_us>;
+
+enum class EventKind : uint8_t {
+  Press,    // a button was pressed at `time_us`
+  Time      // the clock advanced to `time_us`
+};
+
+struct Event {
+  EventKind kind;
+  uint8_t   gpio_num;
+  int64_t   time_us;
+};
+
+enum class ActionKind : uint8_t {
+  ShowTargets,    // `value` is the player LED port, `player` and `time_us`
+                  // the hit that moved the targets, if any
+  ShowScore,      // `value` is the score of `player`
+  Hit,            // `player` hit the target `value` at `time_us`, the
+                  // `ShowTargets` of the hit follows
+  Expired,        // the target of `player` due at `time_us` was not hit, the
+                  // `ShowTargets` moving it follows
+  ShowTime,       // `value` is the remaining game time in tenths of a second
+  ArmTimer,       // wake the firmware with a Time event at `time_us`
+  End             // the game is over
+};
+
+struct Action {
+  ActionKind kind;
+  uint8_t    player;
+  uint16_t   value;
+  int64_t    time_us;
+};
+
+// Actions of a Time step that follows the timer: an expiry with its targets
+// and score for every player, a clock tick, the end with its last tick and
+// the timer
+constexpr inline size_t max_time_actions = 3 * player_count + 4;
+
+// Actions of a press: a hit with its targets and score, the end and the timer
+constexpr inline size_t max_press_actions = 5;
+
+// Actions of a frame: every press of a full input batch after the Time step
+// that brings the clock up to it, and the Time step at the end of the frame
+constexpr inline size_t max_actions =
+config::game::input_queue_size * (max_time_actions + max_press_actions) +
+max_time_actions;
+
+// Start and resume show the time, every score and the targets and arm the
+// timer in one frame
+static_assert(max_actions >= player_count + 3,
+              "The first frame of a game must fit into the actions");
+
+// Actions collected over one or more steps, committed by the firmware at once
+struct Actions {
+  std::array<Action, max_actions> items;
+  size_t                          size;
+  size_t                          dropped;    // pushed while full, lost
+
+  /**
+   * @brief Appends an action, counts it as dropped if the actions are full.
+   *
+   * @return true if the action was appended.
+   */
+  bool push(const Action& action) noexcept {
+    if (size == items.size()) {
+      ++dropped;
+      return false;
+    }
+    items[size++] = action;
+    return true;
+  }
+
+  void clear() noexcept {
+    size    = 0;
+    dropped = 0;
+  }
+
+  [[nodiscard]] const Action* begin() const noexcept {
+    return items.data();
+  }
+
+  [[nodiscard]] const Action* end() const noexcept {
+    return items.data() + size;
+  }
+};
+
+// Target index after each hit of a player, pre-generated at the start of the
+// game unless the target mode is Live. Two 4-bit indices share a byte.
+static_assert(target_count <= 16, "A target index must fit into 4 bits");
+
+class TargetSequence {
+public:
+  static constexpr size_t length = config::game::max_score;
+
+  [[nodiscard]] uint8_t at(const size_t index) const noexcept {
+    return static_cast<uint8_t>(
+    (uint32_t {m_packed[index / 2]} >> get_shift(index)) & 0x0FU);
+  }
+
+  void set(const size_t index, const uint8_t target) noexcept {
+    const uint32_t shift  = get_shift(index);
+    uint8_t&       packed = m_packed[index / 2];
+
+    packed = static_cast<uint8_t>((packed & ~(0x0FU << shift)) |
+                                  (uint32_t {target} << shift));
+  }
+
+private:
+  [[nodiscard]] static constexpr uint32_t
+  get_shift(const size_t index) noexcept {
+    return index % 2 == 0 ? 0 : 4;
+  }
+
+  std::array<uint8_t, (length + 1) / 2> m_packed = {};
+};
+
+// Typical reaction time to each target of each player, 0 if not known yet
+using TargetTimes =
+std::array<std::array<uint32_t, target_count>, player_count>;
+
+// Next target draw of the Adaptive target mode for each player and current
+// target, the current target itself is never drawn
+using TargetTables =
+std::array<std::array<AliasTable<target_count>, target_count>, player_count>;
+
+// What the next hit of a player lights, chosen when the current target is lit
+// so a hit only swaps it in
+struct StagedTarget {
+  uint8_t  target;
+  uint16_t targets;    // the masks like `target_masks` and `decoy_masks`
+  uint16_t decoys;
+};
+
+// The lit buttons of a player are kept as masks of the player LED port, so a
+// press is classified with one AND whatever the number of lit targets.
+// `target_indices` holds one of the targets, the one that decides the next
+// target in the Single and Decoy light modes. `cursors` holds how many
+// entries of its target sequence a player has been shown or staged, penalties
+// lower the score but never walk a sequence back.
+struct GameState {
+  std::array<uint8_t, player_count>          scores;
+  std::array<uint8_t, player_count>          target_indices;
+  std::array<uint16_t, player_count>         target_masks;
+  std::array<uint16_t, player_count>         decoy_masks;
+  std::array<StagedTarget, player_count>     staged;
+  uint16_t                                   target_leds;
+  int64_t                                    start_us;
+  int64_t                                    end_us;
+  int64_t                                    armed_us;
+  Deadlines                                  deadlines;
+  bool                                       over;
+  Random                                     random;
+  std::array<TargetSequence, player_count>   sequences;
+  std::array<uint8_t, player_count>          cursors;
+  const TargetTables*                        tables;
+  Expiries                                   expiries;
+  std::array<Expiries::Handle, player_count> expiry_handles;
+};
+
+// What a running game needs to go on after a reset of the board, only the
+// expiries start anew
+struct Snapshot {
+  std::array<uint8_t, player_count>        scores;
+  std::array<uint8_t, player_count>        target_indices;
+  std::array<uint16_t, player_count>       target_masks;
+  std::array<uint16_t, player_count>       decoy_masks;
+  std::array<StagedTarget, player_count>   staged;
+  std::array<TargetSequence, player_count> sequences;
+  std::array<uint8_t, player_count>        cursors;
+  Random::State                            random;
+  int64_t                                  remaining_us;
+};
+
+void start(GameState&          state,
+           int64_t             now_us,
+           Random              random,
+           const TargetTables& tables,
+           Actions&            actions) noexcept;
+void step(GameState& state, const Event& event, Actions& actions) noexcept;
+
+[[nodiscard]] Snapshot take_snapshot(const GameState& state,
+                                     int64_t          now_us) noexcept;
+void                   resume(GameState&          state,
+                              const Snapshot&     snapshot,
+                              int64_t             now_us,
+                              const TargetTables& tables,
+                              Actions&            actions) noexcept;
+
+[[nodiscard]] uint16_t    get_target_leds(const GameState& state) noexcept;
+[[nodiscard]] const char* get_mode_name() noexcept;
+
+void build_target_tables(const TargetTimes& times_us,
+                         TargetTables&      tables) noexcept;
+
+}    // namespace app::game::core
+
+#endif    //ESP_REFLEX_APP_GAME_CORE_HPP
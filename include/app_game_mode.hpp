@@ -0,0 +1,83 @@
+#ifndef ESP_REFLEX_APP_GAME_MODE_HPP
+#define ESP_REFLEX_APP_GAME_MODE_HPP
+
+#include "app_buttons.hpp"
+#include "app_game_core.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+// A game mode is a type with static hooks that the core calls at the points a
+// variant may differ. The active mode is picked from a registry at compile
+// time, so every hook is a direct call the compiler can inline, without
+// virtual functions or a heap.
+
+namespace app::game::core {
+
+/**
+ * @brief The hooks a game mode provides.
+ *
+ * `on_start` picks the first targets of a started game, `on_resume` lights
+ * the targets of a game resumed from a snapshot, whose scores, masks and
+ * sequences are restored already, `on_press` handles a press of a player
+ * button inside the game time and returns true if it scored, `on_deadline`
+ * handles a timer of the expiry wheel tagged with a player and `on_end` runs
+ * once when the game is over. `id` is the value of
+ * `config::game::Mode` that selects the mode, `name` is shown on the log.
+ */
+template<typename Mode>
+concept GameMode =
+requires(GameState&             state,
+         const buttons::Button& button,
+         const uint8_t          player,
+         const int64_t          time_us,
+         Actions&               actions) {
+  { Mode::id } -> std::convertible_to<config::game::Mode>;
+  { Mode::name } -> std::convertible_to<const char*>;
+  { Mode::on_start(state, time_us, actions) } noexcept -> std::same_as<void>;
+  { Mode::on_resume(state, time_us, actions) } noexcept -> std::same_as<void>;
+  {
+    Mode::on_press(state, button, time_us, actions)
+  } noexcept -> std::same_as<bool>;
+  {
+    Mode::on_deadline(state, player, time_us, actions)
+  } noexcept -> std::same_as<void>;
+  { Mode::on_end(state, actions) } noexcept -> std::same_as<void>;
+};
+
+/**
+ * @brief Compile time list of the available game modes.
+ */
+template<GameMode... Modes>
+struct ModeRegistry {
+  static constexpr size_t size = sizeof...(Modes);
+
+  static constexpr std::array<const char*, size> names = {Modes::name...};
+
+  /**
+   * @brief Returns the position of the mode with the given id, `size` if no
+   * mode has it.
+   */
+  [[nodiscard]] static constexpr size_t
+  find(const config::game::Mode id) noexcept {
+    constexpr std::array<config::game::Mode, size> ids = {Modes::id...};
+
+    for (size_t i = 0; i < size; ++i) {
+      if (ids[i] == id) {
+        return i;
+      }
+    }
+    return size;
+  }
+
+  template<config::game::Mode Id>
+  requires(find(Id) < size)
+  using Select = std::tuple_element_t<find(Id), std::tuple<Modes...>>;
+};
+
+}    // namespace app::game::core
+
+#endif    //ESP_REFLEX_APP_GAME_MODE_HPP
@@ -0,0 +1,276 @@
+#ifndef ESP_REFLEX_APP_GAME_RECORD_HPP
+#define ESP_REFLEX_APP_GAME_RECORD_HPP
+
+#include "app_game_core.hpp"
+#include "app_random.hpp"
+#include "config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// The core is deterministic, so a game is fully described by what it was
+// started with and the events it was stepped with. A record keeps exactly that,
+// around a kilobyte for a game of two players, and `replay` feeds it through
+// the core again, on the device or on a host.
+
+namespace app::game::core {
+
+/**
+ * @brief The start of a game and every event the firmware stepped it with.
+ *
+ * An event is one varint of its zigzagged time offset, shifted left by one
+ * with the lowest bit set for a press, and the GPIO number of a press in the
+ * byte after it. A press is offset from the previous event. A Time event
+ * closes a frame and is offset from the previous event or the wake up the
+ * core asked for, whichever is later, so the clock ticks of a game take a
+ * byte or two. The Time step the firmware makes before each press is implied
+ * by the press.
+ */
+class GameRecord {
+public:
+  using Log = std::array<uint8_t, config::game::record_bytes>;
+
+  /**
+   * @brief Yields the events of a record in order.
+   */
+  class Reader {
+  public:
+    explicit Reader(const GameRecord& record) noexcept
+    : m_record(record), m_last_us(record.m_start_us),
+      m_wake_us(record.m_start_us) {}
+
+    /**
+     * @brief Decodes the next event, returns false at the end of the log or
+     * on a malformed entry.
+     */
+    [[nodiscard]] bool next(Event& event) noexcept {
+      const std::span<const uint8_t> log = m_record.get_log();
+
+      uint64_t value = 0;
+      uint32_t shift = 0;
+      while (true) {
+        if (m_offset >= log.size() || shift >= 64) {
+          return false;
+        }
+
+        const uint8_t byte  = log[m_offset++];
+        value              |= uint64_t {byte & 0x7FU} << shift;
+        shift              += 7;
+        if ((byte & 0x80U) == 0) {
+          break;
+        }
+      }
+
+      const bool     pressed   = (value & 1U) != 0;
+      const uint64_t zigzag    = value >> 1U;
+      const auto     magnitude = static_cast<int64_t>(zigzag >> 1U);
+      const int64_t  offset    = (zigzag & 1U) != 0 ? -magnitude - 1
+                                                    : magnitude;
+
+      event = {EventKind::Time, 0, m_last_us};
+      if (pressed) {
+        if (m_offset >= log.size()) {
+          return false;
+        }
+        event.kind     = EventKind::Press;
+        event.gpio_num = log[m_offset++];
+      } else {
+        event.time_us = std::max(m_last_us, m_wake_us);
+      }
+
+      event.time_us += offset;
+      m_last_us      = event.time_us;
+      return true;
+    }
+
+    /**
+     * @brief Notes the wake up asked for by a frame, like
+     * `GameRecord::commit`.
+     */
+    void commit(const Actions& actions) noexcept {
+      m_wake_us = get_wake_us(actions, m_wake_us);
+    }
+
+    [[nodiscard]] bool at_end() const noexcept {
+      return m_offset == m_record.get_log().size();
+    }
+
+  private:
+    const GameRecord& m_record;
+    size_t            m_offset = 0;
+    int64_t           m_last_us;
+    int64_t           m_wake_us;
+  };
+
+  /**
+   * @brief Clears the log and keeps what the game is started with.
+   *
+   * @param seed The generator state handed to `start`.
+   * @param start_us The start time handed to `start`.
+   * @param times_us The target times the Adaptive target draws were built
+   * from, unused by the other target modes.
+   */
+  void begin(const Random::State& seed,
+             const int64_t        start_us,
+             const TargetTimes&   times_us) noexcept {
+    m_seed      = seed;
+    m_start_us  = start_us;
+    m_times_us  = times_us;
+    m_size      = 0;
+    m_last_us   = start_us;
+    m_wake_us   = start_us;
+    m_truncated = false;
+  }
+
+  /**
+   * @brief Appends an event, drops it and marks the record truncated when the
+   * log is full.
+   */
+  void add(const Event& event) noexcept {
+    std::array<uint8_t, 11> entry = {};
+    size_t                  size  = 0;
+
+    const bool    press  = event.kind == EventKind::Press;
+    const int64_t base   = press ? m_last_us : std::max(m_last_us, m_wake_us);
+    const int64_t offset = event.time_us - base;
+    const auto    zigzag = offset < 0
+                           ? (static_cast<uint64_t>(-(offset + 1)) << 1U) | 1U
+                           : static_cast<uint64_t>(offset) << 1U;
+
+    uint64_t value = (zigzag << 1U) | (press ? 1U : 0U);
+    while (value >= 0x80U) {
+      entry[size++]   = static_cast<uint8_t>(value | 0x80U);
+      value         >>= 7U;
+    }
+    entry[size++] = static_cast<uint8_t>(value);
+    if (press) {
+      entry[size++] = event.gpio_num;
+    }
+
+    if (m_truncated || m_size + size > m_log.size()) {
+      m_truncated = true;
+      return;
+    }
+
+    std::copy_n(entry.begin(), size, m_log.begin() + m_size);
+    m_size    += size;
+    m_last_us  = event.time_us;
+  }
+
+  /**
+   * @brief Notes the wake up asked for by a frame the firmware committed, the
+   * next Time event is offset from it.
+   */
+  void commit(const Actions& actions) noexcept {
+    m_wake_us = get_wake_us(actions, m_wake_us);
+  }
+
+  /**
+   * @brief Replaces the log with one read back from an export, returns false
+   * if it does not fit.
+   */
+  [[nodiscard]] bool load(const std::span<const uint8_t> log) noexcept {
+    if (log.size() > m_log.size()) {
+      return false;
+    }
+
+    std::ranges::copy(log, m_log.begin());
+    m_size = log.size();
+    return true;
+  }
+
+  [[nodiscard]] const Random::State& get_seed() const noexcept {
+    return m_seed;
+  }
+
+  [[nodiscard]] int64_t get_start_us() const noexcept {
+    return m_start_us;
+  }
+
+  [[nodiscard]] const TargetTimes& get_times_us() const noexcept {
+    return m_times_us;
+  }
+
+  [[nodiscard]] std::span<const uint8_t> get_log() const noexcept {
+    return std::span(m_log).first(m_size);
+  }
+
+  // Whether events were dropped, a replay then stops where the log does
+  [[nodiscard]] bool is_truncated() const noexcept {
+    return m_truncated;
+  }
+
+private:
+  [[nodiscard]] static int64_t get_wake_us(const Actions& actions,
+                                           int64_t        wake_us) noexcept {
+    for (const Action& action : actions) {
+      if (action.kind == ActionKind::ArmTimer) {
+        wake_us = action.time_us;
+      }
+    }
+    return wake_us;
+  }
+
+  Random::State m_seed      = {};
+  int64_t       m_start_us  = 0;
+  TargetTimes   m_times_us  = {};
+  Log           m_log       = {};
+  size_t        m_size      = 0;
+  int64_t       m_last_us   = 0;
+  int64_t       m_wake_us   = 0;
+  bool          m_truncated = false;
+};
+
+/**
+ * @brief Feeds a record through the core the same way the game loop did.
+ *
+ * @param record The game to replay.
+ * @param state Receives the state of the replayed game.
+ * @param tables Receives the target draws rebuilt from the record.
+ * @param actions Holds the actions of the current frame.
+ * @param on_frame Called with the actions of every frame the game loop
+ * committed, the first frame of the start included.
+ * @return Whether the whole record was replayed.
+ */
+template<typename OnFrame>
+[[nodiscard]] bool replay(const GameRecord& record,
+                          GameState&        state,
+                          TargetTables&     tables,
+                          Actions&          actions,
+                          OnFrame&&         on_frame) noexcept {
+  build_target_tables(record.get_times_us(), tables);
+
+  actions.clear();
+  start(state,
+        record.get_start_us(),
+        Random(record.get_seed()),
+        tables,
+        actions);
+  GameRecord::Reader reader(record);
+  reader.commit(actions);
+  on_frame(actions);
+  actions.clear();
+
+  Event event = {};
+  while (reader.next(event)) {
+    if (event.kind == EventKind::Press) {
+      step(state, {EventKind::Time, 0, event.time_us}, actions);
+      step(state, event, actions);
+      continue;
+    }
+
+    step(state, event, actions);
+    reader.commit(actions);
+    on_frame(actions);
+    actions.clear();
+  }
+
+  return !record.is_truncated() && reader.at_end();
+}
+
+}    // namespace app::game::core
+
+#endif    //ESP_REFLEX_APP_GAME_RECORD_HPP
@@ -0,0 +1,123 @@
+#ifndef ESP_REFLEX_APP_HISTOGRAM_HPP
+#define ESP_REFLEX_APP_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace app {
+
+/**
+ * @brief Log-linear histogram of microsecond latencies.
+ *
+ * Every power of two is split into four buckets, so a percentile is reported
+ * with at most 25 % error over the whole `uint32_t` range in a fixed 512 bytes.
+ * Recording is a handful of integer operations and never allocates.
+ */
+class LatencyHistogram {
+public:
+  void record(const int64_t value_us) noexcept {
+    const auto value = static_cast<uint32_t>(
+    std::clamp<int64_t>(value_us, 0, std::numeric_limits<uint32_t>::max()));
+
+    ++m_buckets[get_bucket(value)];
+    ++m_count;
+    m_total_us += value;
+    m_max_us    = std::max(m_max_us, value);
+  }
+
+  void merge(const LatencyHistogram& other) noexcept {
+    for (size_t i = 0; i < bucket_count; ++i) {
+      m_buckets[i] += other.m_buckets[i];
+    }
+    m_count    += other.m_count;
+    m_total_us += other.m_total_us;
+    m_max_us    = std::max(m_max_us, other.m_max_us);
+  }
+
+  void clear() noexcept {
+    *this = {};
+  }
+
+  [[nodiscard]] uint32_t count() const noexcept {
+    return m_count;
+  }
+
+  [[nodiscard]] uint32_t mean_us() const noexcept {
+    return m_count > 0 ? static_cast<uint32_t>(m_total_us / m_count) : 0;
+  }
+
+  [[nodiscard]] uint32_t max_us() const noexcept {
+    return m_max_us;
+  }
+
+  /**
+   * @brief Returns the upper bound of the bucket holding the given percentile.
+   *
+   * @param percent The percentile, 0 to 100.
+   * @return The latency in us, 0 if nothing was recorded.
+   */
+  [[nodiscard]] uint32_t percentile_us(const uint32_t percent) const noexcept {
+    if (m_count == 0) {
+      return 0;
+    }
+
+    const uint64_t rank =
+    (uint64_t {m_count} * std::min<uint32_t>(percent, 100) + 99) / 100;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+      seen += m_buckets[i];
+      if (seen >= rank && seen > 0) {
+        return std::min(get_upper_bound(i), m_max_us);
+      }
+    }
+
+    return m_max_us;
+  }
+
+private:
+  static constexpr uint32_t sub_bits     = 2;
+  static constexpr uint32_t sub_count    = 1U << sub_bits;
+  static constexpr size_t   bucket_count = (32 - sub_bits + 1) * sub_count;
+
+  [[nodiscard]] static constexpr size_t
+  get_bucket(const uint32_t value) noexcept {
+    if (value < sub_count) {
+      return value;
+    }
+
+    const uint32_t msb = 31U - static_cast<uint32_t>(std::countl_zero(value));
+    const auto sub = (value >> (msb - sub_bits)) & (sub_count - 1);
+    return (msb - sub_bits + 1) * sub_count + sub;
+  }
+
+  [[nodiscard]] static constexpr uint32_t
+  get_lower_bound(const size_t bucket) noexcept {
+    if (bucket < sub_count) {
+      return static_cast<uint32_t>(bucket);
+    }
+
+    const auto msb = static_cast<uint32_t>(bucket / sub_count) + sub_bits - 1;
+    const auto sub = static_cast<uint32_t>(bucket % sub_count);
+    return (sub_count + sub) << (msb - sub_bits);
+  }
+
+  [[nodiscard]] static constexpr uint32_t
+  get_upper_bound(const size_t bucket) noexcept {
+    return bucket + 1 < bucket_count ? get_lower_bound(bucket + 1) - 1
+                                     : std::numeric_limits<uint32_t>::max();
+  }
+
+  std::array<uint32_t, bucket_count> m_buckets  = {};
+  uint32_t                           m_count    = 0;
+  uint32_t                           m_max_us   = 0;
+  uint64_t                           m_total_us = 0;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_HISTOGRAM_HPP
@@ -0,0 +1,15 @@
+#ifndef ESP_REFLEX_APP_HISTORY_HPP
+#define ESP_REFLEX_APP_HISTORY_HPP
+
+// Hits and reaction times of past games, kept in a ring in flash and streamed
+// to the log on demand
+
+namespace app::history {
+
+void init() noexcept;
+void add_last_game() noexcept;
+void export_games() noexcept;
+
+}    // namespace app::history
+
+#endif    //ESP_REFLEX_APP_HISTORY_HPP
@@ -0,0 +1,268 @@
+#ifndef ESP_REFLEX_APP_HISTORY_CODEC_HPP
+#define ESP_REFLEX_APP_HISTORY_CODEC_HPP
+
+#include "config.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Compact encoding of the hits of a game. The hits are stored by column, so
+// like values sit next to each other: the hit times as varints of the zigzagged
+// difference to the previous hit, the player and target of every hit packed
+// into a few bits, and the reaction times as varints. Times are in ms, a game
+// of two players takes a few hundred bytes.
+
+namespace app::history {
+
+// Every hit of a game that ends at the max score. With penalties or expiring
+// targets a game can take more hits, those past the cap are dropped and the
+// game is marked truncated.
+constexpr inline size_t max_hits =
+config::stations::stations.size() * config::game::max_score;
+
+struct Hit {
+  uint32_t time_ms;        // since the go
+  uint32_t reaction_ms;    // since the target was lit
+  uint8_t  player;
+  uint8_t  target;
+};
+
+struct Game {
+  uint32_t                  duration_ms;
+  std::array<Hit, max_hits> hits;
+  size_t                    hit_count;
+  bool                      truncated;    // hits were dropped past `max_hits`
+
+  void clear() noexcept {
+    duration_ms = 0;
+    hit_count   = 0;
+    truncated   = false;
+  }
+
+  void add(const Hit& hit) noexcept {
+    if (hit_count < hits.size()) {
+      hits[hit_count++] = hit;
+    } else {
+      truncated = true;
+    }
+  }
+};
+
+namespace impl {
+
+constexpr inline uint32_t player_bits = static_cast<uint32_t>(
+std::bit_width(config::stations::stations.size() - 1));
+constexpr inline uint32_t target_bits = static_cast<uint32_t>(
+std::bit_width(config::stations::targets_per_station - 1));
+constexpr inline uint32_t hit_bits    = player_bits + target_bits;
+
+// The longest varint of a 32-bit value
+constexpr inline size_t max_varint = 5;
+
+}    // namespace impl
+
+// Bytes the encoding of a game needs at most
+constexpr inline size_t max_encoded =
+3 * impl::max_varint + max_hits * 2 * impl::max_varint +
+(max_hits * impl::hit_bits + 7) / 8;
+
+namespace impl {
+
+class Writer {
+public:
+  explicit Writer(const std::span<uint8_t> out) noexcept : m_out(out) {}
+
+  void varint(uint32_t value) noexcept {
+    while (value >= 0x80U) {
+      byte(static_cast<uint8_t>(value | 0x80U));
+      value >>= 7U;
+    }
+    byte(static_cast<uint8_t>(value));
+  }
+
+  // Least significant bit first, call `flush` after the last bits
+  void bits(const uint32_t value, const uint32_t count) noexcept {
+    m_bits       |= value << m_bit_count;
+    m_bit_count  += count;
+    while (m_bit_count >= 8) {
+      byte(static_cast<uint8_t>(m_bits));
+      m_bits      >>= 8U;
+      m_bit_count  -= 8;
+    }
+  }
+
+  void flush() noexcept {
+    if (m_bit_count > 0) {
+      byte(static_cast<uint8_t>(m_bits));
+    }
+    m_bits      = 0;
+    m_bit_count = 0;
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return m_overflow ? 0 : m_size;
+  }
+
+private:
+  void byte(const uint8_t value) noexcept {
+    if (m_size < m_out.size()) {
+      m_out[m_size++] = value;
+    } else {
+      m_overflow = true;
+    }
+  }
+
+  std::span<uint8_t> m_out;
+  size_t             m_size      = 0;
+  uint32_t           m_bits      = 0;
+  uint32_t           m_bit_count = 0;
+  bool               m_overflow  = false;
+};
+
+class Reader {
+public:
+  explicit Reader(const std::span<const uint8_t> in) noexcept : m_in(in) {}
+
+  [[nodiscard]] uint32_t varint() noexcept {
+    uint32_t value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+      const uint8_t next  = byte();
+      value              |= uint32_t {next & 0x7FU} << shift;
+      if ((next & 0x80U) == 0) {
+        break;
+      }
+    }
+    return value;
+  }
+
+  [[nodiscard]] uint32_t bits(const uint32_t count) noexcept {
+    while (m_bit_count < count) {
+      m_bits      |= uint32_t {byte()} << m_bit_count;
+      m_bit_count += 8;
+    }
+
+    const uint32_t value   = m_bits & ((1U << count) - 1U);
+    m_bits               >>= count;
+    m_bit_count           -= count;
+    return value;
+  }
+
+  // Drops the bits left of the last byte of a bit column
+  void align() noexcept {
+    m_bits      = 0;
+    m_bit_count = 0;
+  }
+
+  [[nodiscard]] bool ok() const noexcept {
+    return !m_underflow;
+  }
+
+private:
+  [[nodiscard]] uint8_t byte() noexcept {
+    if (m_offset < m_in.size()) {
+      return m_in[m_offset++];
+    }
+    m_underflow = true;
+    return 0;
+  }
+
+  std::span<const uint8_t> m_in;
+  size_t                   m_offset    = 0;
+  uint32_t                 m_bits      = 0;
+  uint32_t                 m_bit_count = 0;
+  bool                     m_underflow = false;
+};
+
+[[nodiscard]] constexpr uint32_t zigzag(const int64_t value) noexcept {
+  return static_cast<uint32_t>(value < 0 ? ((-(value + 1)) << 1) | 1
+                                         : value << 1);
+}
+
+[[nodiscard]] constexpr int64_t unzigzag(const uint32_t value) noexcept {
+  const auto magnitude = int64_t {value >> 1U};
+  return (value & 1U) != 0 ? -magnitude - 1 : magnitude;
+}
+
+}    // namespace impl
+
+/**
+ * @brief Encodes a game.
+ *
+ * The hit count is shifted left by one, the lowest bit is set for a truncated
+ * game.
+ *
+ * @return The number of bytes written, 0 if they did not fit.
+ */
+[[nodiscard]] inline size_t encode(const Game&              game,
+                                   const std::span<uint8_t> out) noexcept {
+  impl::Writer writer(out);
+
+  writer.varint(game.duration_ms);
+  writer.varint(static_cast<uint32_t>(game.hit_count << 1U) |
+                (game.truncated ? 1U : 0U));
+
+  const std::span<const Hit> hits = std::span(game.hits).first(game.hit_count);
+
+  // The difference wraps around like the times do, so it fits into 32 bits
+  uint32_t last_ms = 0;
+  for (const Hit& hit : hits) {
+    writer.varint(impl::zigzag(static_cast<int32_t>(hit.time_ms - last_ms)));
+    last_ms = hit.time_ms;
+  }
+
+  for (const Hit& hit : hits) {
+    writer.bits(hit.player, impl::player_bits);
+    writer.bits(hit.target, impl::target_bits);
+  }
+  writer.flush();
+
+  for (const Hit& hit : hits) {
+    writer.varint(hit.reaction_ms);
+  }
+
+  return writer.size();
+}
+
+/**
+ * @brief Decodes a game, returns false if the bytes are not a whole game.
+ */
+[[nodiscard]] inline bool decode(const std::span<const uint8_t> in,
+                                 Game&                          game) noexcept {
+  impl::Reader reader(in);
+
+  game.duration_ms = reader.varint();
+
+  const uint32_t count = reader.varint();
+  game.hit_count       = count >> 1U;
+  game.truncated       = (count & 1U) != 0;
+  if (game.hit_count > game.hits.size()) {
+    return false;
+  }
+
+  const std::span<Hit> hits = std::span(game.hits).first(game.hit_count);
+
+  int64_t last_ms = 0;
+  for (Hit& hit : hits) {
+    last_ms     += impl::unzigzag(reader.varint());
+    hit.time_ms  = static_cast<uint32_t>(last_ms);
+  }
+
+  for (Hit& hit : hits) {
+    hit.player = static_cast<uint8_t>(reader.bits(impl::player_bits));
+    hit.target = static_cast<uint8_t>(reader.bits(impl::target_bits));
+  }
+  reader.align();
+
+  for (Hit& hit : hits) {
+    hit.reaction_ms = reader.varint();
+  }
+
+  return reader.ok();
+}
+
+}    // namespace app::history
+
+#endif    //ESP_REFLEX_APP_HISTORY_CODEC_HPP
@@ -0,0 +1,69 @@
+#ifndef ESP_REFLEX_APP_INPUT_HPP
+#define ESP_REFLEX_APP_INPUT_HPP
+
+#include <freertos/FreeRTOS.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace app::input {
+
+// Which group of buttons the ISRs forward to the input queue. Switching the
+// phase is a single atomic store, the handlers themselves stay attached.
+enum class Phase : uint8_t {
+  Disabled,
+  Start,
+  Players
+};
+
+// How the native button pins are read, edge interrupts or fixed rate sampling
+// by a hardware timer
+enum class Mode : uint8_t {
+  Edge,
+  Sampled
+};
+
+struct Event {
+  int64_t timestamp_us;    // esp_timer_get_time() when the ISR ran
+  uint8_t gpio_num;
+};
+
+// GPIO number of the events queued by `wake`, never returned by the receive
+// functions
+constexpr inline uint8_t wake_gpio_num = std::numeric_limits<uint8_t>::max();
+
+struct BatchStats {
+  uint32_t batches;
+  uint32_t events;
+  uint32_t dropped;            // presses lost because the queue was full
+  uint8_t  max_batch_size;
+  int64_t  total_queue_time_us;
+  int64_t  max_queue_time_us;
+  uint32_t edge_isr_calls;
+  uint32_t edge_isr_cycles;    // CPU cycles spent in the edge ISRs
+};
+
+void init() noexcept;
+void set_phase(Phase phase) noexcept;
+void post(const Event& event) noexcept;
+void post_from_isr(const Event& event, BaseType_t& task_woken) noexcept;
+void wake() noexcept;
+
+void               set_mode(Mode mode) noexcept;
+[[nodiscard]] Mode get_mode() noexcept;
+
+[[nodiscard]] bool   receive(Event& event, TickType_t timeout) noexcept;
+[[nodiscard]] size_t receive_batch(std::span<Event> events,
+                                   TickType_t       timeout) noexcept;
+
+[[nodiscard]] size_t get_queue_depth() noexcept;
+
+[[nodiscard]] BatchStats get_batch_stats() noexcept;
+void                     reset_batch_stats() noexcept;
+void                     log_stats() noexcept;
+
+}    // namespace app::input
+
+#endif    //ESP_REFLEX_APP_INPUT_HPP
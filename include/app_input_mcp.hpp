@@ -0,0 +1,26 @@
+#ifndef ESP_REFLEX_APP_INPUT_MCP_HPP
+#define ESP_REFLEX_APP_INPUT_MCP_HPP
+
+#include <cstdint>
+
+// Reads the player buttons on the interrupt-on-change banks of the button
+// MCP23017 and posts them with their expander button ids
+
+namespace app::input::mcp {
+
+struct Stats {
+  uint32_t reads;               // INTF + INTCAP burst reads
+  uint32_t failed_reads;
+  uint32_t events;
+  int64_t  total_latency_us;    // INT edge until the events of a read are queued
+  int64_t  max_latency_us;
+};
+
+void init() noexcept;
+
+[[nodiscard]] Stats get_stats() noexcept;
+void                reset_stats() noexcept;
+
+}    // namespace app::input::mcp
+
+#endif    //ESP_REFLEX_APP_INPUT_MCP_HPP
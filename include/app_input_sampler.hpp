@@ -0,0 +1,26 @@
+#ifndef ESP_REFLEX_APP_INPUT_SAMPLER_HPP
+#define ESP_REFLEX_APP_INPUT_SAMPLER_HPP
+
+#include <cstdint>
+
+// Alternative to the edge interrupts: a hardware timer samples all native
+// button pins at a fixed rate and debounces them with an integrator
+
+namespace app::input::sampler {
+
+struct Stats {
+  uint32_t samples;
+  uint32_t events;
+  uint64_t total_cycles;    // CPU cycles spent in the sampling ISR
+  uint32_t max_cycles;
+};
+
+void start(uint32_t rate_hz) noexcept;
+void stop() noexcept;
+
+[[nodiscard]] Stats get_stats() noexcept;
+void                reset_stats() noexcept;
+
+}    // namespace app::input::sampler
+
+#endif    //ESP_REFLEX_APP_INPUT_SAMPLER_HPP
@@ -0,0 +1,35 @@
+#ifndef ESP_REFLEX_APP_LEADERBOARD_HPP
+#define ESP_REFLEX_APP_LEADERBOARD_HPP
+
+#include "config.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Best scores of all games, kept across resets in a log in flash
+
+namespace app::leaderboard {
+
+struct Score {
+  uint32_t game;           // number of the game since the log was created
+  uint16_t reaction_ms;    // mean reaction time of the player in the game
+  uint8_t  station;
+  uint8_t  score;
+};
+
+// Best first
+struct Top {
+  std::array<Score, config::leaderboard::top_count> scores;
+  size_t                                            size;
+};
+
+void init() noexcept;
+void add_last_game() noexcept;
+void log() noexcept;
+
+[[nodiscard]] Top get_top() noexcept;
+
+}    // namespace app::leaderboard
+
+#endif    //ESP_REFLEX_APP_LEADERBOARD_HPP
@@ -0,0 +1,80 @@
+#ifndef ESP_REFLEX_APP_LOADGEN_HPP
+#define ESP_REFLEX_APP_LOADGEN_HPP
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Simulated players that press the buttons of the current targets through the
+// input queue, so the whole path from queue to lit target is measured under
+// load without anyone at the buttons
+
+namespace app::loadgen {
+
+struct BotProfile {
+  uint32_t reaction_min_us;
+  uint32_t reaction_max_us;
+  uint8_t  miss_percent;        // presses on a wrong button of the player
+  uint32_t min_events_per_s;    // the run fails below this
+  uint32_t max_dropped;         // the run fails above this
+  uint32_t max_p99_us;          // the run fails above this
+  uint8_t  burst;               // presses per turn of a player, at once,
+                                // each on the next button
+};
+
+/**
+ * @brief Returns the simulated players and the limits of a profile, shared
+ * with the host driver of the load generator in `test/`.
+ */
+[[nodiscard]] constexpr BotProfile
+get_profile(const config::loadgen::Profile profile) noexcept {
+  switch (profile) {
+    case config::loadgen::Profile::Fast:
+      return {20'000, 60'000, 0, 40, 0, 5'000, 1};
+    case config::loadgen::Profile::Spam:
+      // Losing presses is expected here, the game must keep up regardless
+      return {0,
+              0,
+              50,
+              1'000,
+              std::numeric_limits<uint32_t>::max(),
+              20'000,
+              1};
+    case config::loadgen::Profile::Burst:
+      // Every turn of a player is more than the input queue holds, sweeping
+      // all of its buttons, so the game loop gets a full batch of hits and
+      // misses each round and the presses past it are dropped
+      return {5'000,
+              20'000,
+              20,
+              500,
+              std::numeric_limits<uint32_t>::max(),
+              20'000,
+              config::game::input_queue_size + 2};
+    case config::loadgen::Profile::Human:
+    default:
+      return {200'000, 450'000, 5, 3, 0, 5'000, 1};
+  }
+}
+
+struct Report {
+  uint32_t presses;             // presses posted by the simulated players
+  uint32_t events;              // presses handled by the game loop
+  uint32_t dropped;             // presses lost because the queue was full
+  size_t   max_queue_depth;
+  int64_t  duration_us;
+  uint32_t events_per_s;
+  uint32_t latency_p50_us;      // press to next target
+  uint32_t latency_p95_us;
+  uint32_t latency_p99_us;
+  bool     passed;
+};
+
+void                 start() noexcept;
+[[nodiscard]] Report finish() noexcept;
+
+}    // namespace app::loadgen
+
+#endif    //ESP_REFLEX_APP_LOADGEN_HPP
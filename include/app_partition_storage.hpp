@@ -0,0 +1,62 @@
+#ifndef ESP_REFLEX_APP_PARTITION_STORAGE_HPP
+#define ESP_REFLEX_APP_PARTITION_STORAGE_HPP
+
+#include <esp_err.h>
+#include <esp_partition.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace app {
+
+/**
+ * @brief `LogStorage` in a data partition of the SPI flash.
+ */
+class PartitionStorage {
+public:
+  // Erase unit of the SPI flash
+  static constexpr size_t sector_size = 4096;
+
+  /**
+   * @brief Finds the data partition with the given label, returns false if
+   * there is none.
+   */
+  [[nodiscard]] bool open(const char* label) noexcept {
+    m_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                           ESP_PARTITION_SUBTYPE_ANY,
+                                           label);
+    return m_partition != nullptr;
+  }
+
+  [[nodiscard]] size_t sector_count() const noexcept {
+    return m_partition != nullptr ? m_partition->size / sector_size : 0;
+  }
+
+  [[nodiscard]] bool read(const size_t             offset,
+                          const std::span<uint8_t> data) noexcept {
+    return esp_partition_read(m_partition, offset, data.data(), data.size()) ==
+           ESP_OK;
+  }
+
+  [[nodiscard]] bool write(const size_t                   offset,
+                           const std::span<const uint8_t> data) noexcept {
+    return esp_partition_write(m_partition,
+                               offset,
+                               data.data(),
+                               data.size()) == ESP_OK;
+  }
+
+  [[nodiscard]] bool erase(const size_t sector) noexcept {
+    return esp_partition_erase_range(m_partition,
+                                     sector * sector_size,
+                                     sector_size) == ESP_OK;
+  }
+
+private:
+  const esp_partition_t* m_partition = nullptr;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_PARTITION_STORAGE_HPP
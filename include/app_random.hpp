@@ -0,0 +1,99 @@
+#ifndef ESP_REFLEX_APP_RANDOM_HPP
+#define ESP_REFLEX_APP_RANDOM_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace app {
+
+/**
+ * @brief xoshiro128++ pseudo random number generator.
+ *
+ * 32-bit arithmetic only, so a draw is a few instructions on the ESP32. The
+ * whole state is four words that can be saved and restored to replay a game.
+ */
+class Random {
+public:
+  using State = std::array<uint32_t, 4>;
+
+  Random() noexcept {
+    seed(0);
+  }
+
+  explicit Random(const State& state) noexcept : m_state(state) {}
+
+  /**
+   * @brief Expands a seed into a full state with splitmix32, so any seed,
+   * including 0, gives a valid state.
+   */
+  void seed(uint32_t seed) noexcept {
+    for (uint32_t& word : m_state) {
+      seed += 0x9E37'79B9U;
+
+      uint32_t z = seed;
+      z          = (z ^ (z >> 16U)) * 0x85EB'CA6BU;
+      z          = (z ^ (z >> 13U)) * 0xC2B2'AE35U;
+      word       = z ^ (z >> 16U);
+    }
+  }
+
+  [[nodiscard]] const State& get_state() const noexcept {
+    return m_state;
+  }
+
+  [[nodiscard]] uint32_t next() noexcept {
+    const uint32_t result = std::rotl(m_state[0] + m_state[3], 7) + m_state[0];
+    const uint32_t t      = m_state[1] << 9U;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3]  = std::rotl(m_state[3], 11);
+
+    return result;
+  }
+
+  /**
+   * @brief Returns a value in [0, bound) without a modulo.
+   *
+   * Lemire's multiply and shift, the bias is below bound / 2^32 which is
+   * irrelevant for the small bounds of the game, and it never loops.
+   */
+  [[nodiscard]] uint32_t below(const uint32_t bound) noexcept {
+    return static_cast<uint32_t>((uint64_t {next()} * bound) >> 32U);
+  }
+
+  /**
+   * @brief Returns a value in [0, bound) that differs from `current`.
+   *
+   * Draws from the bound - 1 other values and skips over `current`, one draw
+   * in constant time. A `current` outside the range excludes nothing.
+   */
+  [[nodiscard]] uint32_t below_except(const uint32_t bound,
+                                      const uint32_t current) noexcept {
+    if (current >= bound) {
+      return below(bound);
+    }
+
+    const uint32_t value = below(bound - 1);
+    return value >= current ? value + 1 : value;
+  }
+
+private:
+  State m_state = {};
+};
+
+/**
+ * @brief Returns the generator shared by the firmware, seeded once at boot.
+ */
+[[nodiscard]] inline Random& get_random() noexcept {
+  static Random s_random;
+  return s_random;
+}
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_RANDOM_HPP
@@ -0,0 +1,333 @@
+#ifndef ESP_REFLEX_APP_RECORD_RING_HPP
+#define ESP_REFLEX_APP_RECORD_RING_HPP
+
+#include "app_append_log.hpp"
+#include "app_crc32.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace app {
+
+/**
+ * @brief Ring of variable size records in flash sectors, the oldest records
+ * are dropped when it is full.
+ *
+ * A record is a header of its size, its sequence number and a CRC, followed by
+ * the data, and never crosses a sector. The first bytes of a sector hold its
+ * generation, the sector with the highest one is the current sector. A record
+ * that does not fit into the rest of the current sector goes into the next
+ * sector, which is erased first. Records are read back in chunks, so a reader
+ * never needs a whole record in RAM.
+ *
+ * @tparam Storage The flash, see `LogStorage`, at least two sectors.
+ */
+template<LogStorage Storage>
+class RecordRing {
+  struct Header {
+    uint16_t size;
+    uint32_t sequence;
+    uint32_t crc;    // of the sequence number and the data
+  };
+
+  struct SectorHeader {
+    uint32_t generation;
+    uint32_t crc;
+  };
+
+  static constexpr size_t header_size        = 10;
+  static constexpr size_t sector_header_size = sizeof(SectorHeader);
+  static constexpr size_t chunk_size         = 64;
+
+public:
+  static constexpr size_t max_size =
+  Storage::sector_size - sector_header_size - header_size;
+
+  explicit RecordRing(Storage& storage) noexcept : m_storage(storage) {}
+
+  /**
+   * @brief Finds the current sector and the end of its records.
+   *
+   * @return False if the storage failed or has less than two sectors.
+   */
+  [[nodiscard]] bool load() noexcept {
+    const size_t count = m_storage.sector_count();
+    if (count < 2) {
+      return false;
+    }
+
+    bool found = false;
+    for (size_t sector = 0; sector < count; ++sector) {
+      uint32_t generation = 0;
+      if (read_generation(sector, generation) &&
+          (!found || generation > m_generation)) {
+        found        = true;
+        m_generation = generation;
+        m_current    = sector;
+      }
+    }
+
+    if (!found) {
+      return start_sector(0, 1);
+    }
+
+    // Sequence numbers go on from the newest intact record, new records go
+    // after the last one of the current sector
+    m_write = sector_header_size;
+    for (size_t sector = 0; sector < count; ++sector) {
+      uint32_t generation = 0;
+      if (!read_generation(sector, generation)) {
+        continue;
+      }
+
+      const bool scanned =
+      for_each_header(sector, [&](const size_t offset, const Header& header) {
+        if (is_intact(get_offset(sector, offset), header)) {
+          m_next_sequence = std::max(m_next_sequence, header.sequence + 1);
+        }
+        if (sector == m_current) {
+          m_write = offset + header_size + header.size;
+        }
+      });
+      if (!scanned) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Appends a record.
+   *
+   * @return False if it is larger than `max_size` or the storage failed.
+   */
+  [[nodiscard]] bool append(const std::span<const uint8_t> data) noexcept {
+    if (data.size() > max_size) {
+      return false;
+    }
+
+    if (m_write + header_size + data.size() > Storage::sector_size &&
+        !start_sector((m_current + 1) % m_storage.sector_count(),
+                      m_generation + 1)) {
+      return false;
+    }
+
+    const Header header = {
+    static_cast<uint16_t>(data.size()),
+    m_next_sequence,
+    crc32(data, crc32(as_bytes(m_next_sequence)))};
+
+    std::array<uint8_t, header_size> bytes = {};
+    std::memcpy(bytes.data(), &header.size, sizeof(header.size));
+    std::memcpy(bytes.data() + 2, &header.sequence, sizeof(header.sequence));
+    std::memcpy(bytes.data() + 6, &header.crc, sizeof(header.crc));
+
+    const size_t offset = m_current * Storage::sector_size + m_write;
+    if (!m_storage.write(offset, bytes) ||
+        !m_storage.write(offset + header_size, data)) {
+      // The sector cannot take more records
+      m_write = Storage::sector_size;
+      return false;
+    }
+
+    m_write += header_size + data.size();
+    ++m_next_sequence;
+    return true;
+  }
+
+  /**
+   * @brief Streams every intact record, the oldest first.
+   *
+   * Each record is read twice in chunks, once to check its CRC and once to
+   * hand it on.
+   *
+   * @param on_chunk Called with the sequence number of the record, the offset
+   * of the chunk in the record and the chunk of at most 64 bytes. A record
+   * starts with offset 0, an empty record is one empty chunk.
+   * @return False if the storage failed.
+   */
+  template<typename OnChunk>
+  [[nodiscard]] bool stream(OnChunk&& on_chunk) noexcept {
+    const size_t count = m_storage.sector_count();
+
+    for (size_t i = 1; i <= count; ++i) {
+      const size_t sector     = (m_current + i) % count;
+      uint32_t     generation = 0;
+      if (!read_generation(sector, generation)) {
+        continue;
+      }
+
+      bool       read_ok = true;
+      const bool scanned =
+      for_each_header(sector, [&](const size_t offset, const Header& header) {
+        read_ok = read_ok &&
+                  stream_record(get_offset(sector, offset), header, on_chunk);
+      });
+      if (!scanned || !read_ok) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+private:
+  [[nodiscard]] static std::array<uint8_t, sizeof(uint32_t)>
+  as_bytes(const uint32_t value) noexcept {
+    std::array<uint8_t, sizeof(uint32_t)> bytes = {};
+    std::memcpy(bytes.data(), &value, sizeof(value));
+    return bytes;
+  }
+
+  [[nodiscard]] bool read_generation(const size_t sector,
+                                     uint32_t&    generation) noexcept {
+    std::array<uint8_t, sector_header_size> bytes = {};
+    if (!m_storage.read(sector * Storage::sector_size, bytes)) {
+      return false;
+    }
+
+    // An erased header would pass, the CRC of four 0xFF bytes is 0xFFFFFFFF
+    if (std::ranges::all_of(bytes, [](const uint8_t byte) noexcept {
+          return byte == 0xFF;
+        })) {
+      return false;
+    }
+
+    SectorHeader header = {};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    generation = header.generation;
+    return header.crc == crc32(as_bytes(header.generation));
+  }
+
+  /**
+   * @brief Erases a sector and makes it the current one.
+   */
+  [[nodiscard]] bool start_sector(const size_t   sector,
+                                  const uint32_t generation) noexcept {
+    const SectorHeader header = {generation,
+                                 crc32(as_bytes(generation))};
+
+    std::array<uint8_t, sector_header_size> bytes = {};
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    if (!m_storage.erase(sector) ||
+        !m_storage.write(sector * Storage::sector_size, bytes)) {
+      return false;
+    }
+
+    m_current    = sector;
+    m_generation = generation;
+    m_write      = sector_header_size;
+    return true;
+  }
+
+  /**
+   * @brief Calls `on_header` with the offset and the header of every record
+   * of a sector, up to the first blank or torn header.
+   */
+  template<typename OnHeader>
+  [[nodiscard]] bool for_each_header(const size_t sector,
+                                     OnHeader&&   on_header) noexcept {
+    size_t offset = sector_header_size;
+    while (offset + header_size <= Storage::sector_size) {
+      std::array<uint8_t, header_size> bytes = {};
+      if (!m_storage.read(sector * Storage::sector_size + offset, bytes)) {
+        return false;
+      }
+
+      Header header = {};
+      std::memcpy(&header.size, bytes.data(), sizeof(header.size));
+      std::memcpy(&header.sequence, bytes.data() + 2, sizeof(header.sequence));
+      std::memcpy(&header.crc, bytes.data() + 6, sizeof(header.crc));
+      if (header.size > max_size ||
+          offset + header_size + header.size > Storage::sector_size) {
+        // A blank header ends the records, a torn one the usable sector
+        if (std::ranges::any_of(bytes, [](const uint8_t byte) noexcept {
+              return byte != 0xFF;
+            }) &&
+            sector == m_current) {
+          m_write = Storage::sector_size;
+        }
+        break;
+      }
+
+      on_header(offset, header);
+      offset += header_size + header.size;
+    }
+    return true;
+  }
+
+  // Where the data of the record at `offset` in a sector starts
+  [[nodiscard]] static constexpr size_t
+  get_offset(const size_t sector, const size_t offset) noexcept {
+    return sector * Storage::sector_size + offset + header_size;
+  }
+
+  /**
+   * @brief Returns whether the data of a record matches its CRC.
+   */
+  [[nodiscard]] bool is_intact(const size_t  offset,
+                               const Header& header) noexcept {
+    uint32_t   crc     = crc32(as_bytes(header.sequence));
+    const bool read_ok = read_chunks(
+    offset,
+    header.size,
+    [&crc](size_t /*done*/, const std::span<const uint8_t> chunk) noexcept {
+      crc = crc32(chunk, crc);
+    });
+    return read_ok && crc == header.crc;
+  }
+
+  /**
+   * @brief Hands on a record if it is intact.
+   */
+  template<typename OnChunk>
+  [[nodiscard]] bool stream_record(const size_t  offset,
+                                   const Header& header,
+                                   OnChunk&      on_chunk) noexcept {
+    if (!is_intact(offset, header)) {
+      return true;
+    }
+
+    if (header.size == 0) {
+      on_chunk(header.sequence, size_t {0}, std::span<const uint8_t> {});
+      return true;
+    }
+    return read_chunks(offset,
+                       header.size,
+                       [&](const size_t                   done,
+                           const std::span<const uint8_t> chunk) {
+                         on_chunk(header.sequence, done, chunk);
+                       });
+  }
+
+  template<typename OnChunk>
+  [[nodiscard]] bool read_chunks(const size_t offset,
+                                 const size_t size,
+                                 OnChunk&&    on_chunk) noexcept {
+    std::array<uint8_t, chunk_size> chunk = {};
+
+    for (size_t done = 0; done < size; done += chunk.size()) {
+      const std::span<uint8_t> part =
+      std::span(chunk).first(std::min(chunk.size(), size - done));
+      if (!m_storage.read(offset + done, part)) {
+        return false;
+      }
+      on_chunk(done, std::span<const uint8_t>(part));
+    }
+    return true;
+  }
+
+  Storage& m_storage;
+  size_t   m_current       = 0;
+  size_t   m_write         = sector_header_size;
+  uint32_t m_generation    = 0;
+  uint32_t m_next_sequence = 1;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_RECORD_RING_HPP
@@ -0,0 +1,63 @@
+#ifndef ESP_REFLEX_APP_RUNNING_STATS_HPP
+#define ESP_REFLEX_APP_RUNNING_STATS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace app {
+
+/**
+ * @brief Count, minimum, mean and variance of a stream of values in constant
+ * memory.
+ *
+ * Welford's online update, numerically stable in single precision floats,
+ * which the ESP32 computes in hardware.
+ */
+class RunningStats {
+public:
+  void record(const uint32_t value) noexcept {
+    const auto sample = static_cast<float>(value);
+
+    ++m_count;
+    m_min = std::min(m_min, value);
+
+    const float delta  = sample - m_mean;
+    m_mean            += delta / static_cast<float>(m_count);
+    m_m2              += delta * (sample - m_mean);
+  }
+
+  [[nodiscard]] uint32_t count() const noexcept {
+    return m_count;
+  }
+
+  [[nodiscard]] uint32_t min() const noexcept {
+    return m_count > 0 ? m_min : 0;
+  }
+
+  [[nodiscard]] float mean() const noexcept {
+    return m_mean;
+  }
+
+  /**
+   * @brief Returns the sample variance, 0 for less than two values.
+   */
+  [[nodiscard]] float variance() const noexcept {
+    return m_count > 1 ? m_m2 / static_cast<float>(m_count - 1) : 0.0F;
+  }
+
+  [[nodiscard]] float stddev() const noexcept {
+    return std::sqrt(variance());
+  }
+
+private:
+  uint32_t m_count = 0;
+  uint32_t m_min   = std::numeric_limits<uint32_t>::max();
+  float    m_mean  = 0.0F;
+  float    m_m2    = 0.0F;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_RUNNING_STATS_HPP
@@ -0,0 +1,18 @@
+#ifndef ESP_REFLEX_APP_SNAPSHOT_HPP
+#define ESP_REFLEX_APP_SNAPSHOT_HPP
+
+#include "app_game_core.hpp"
+
+// The running game in RTC memory, which keeps its content through every reset
+// but a power on, so a game cut short by a crash, a watchdog or a brownout
+// goes on where it stopped
+
+namespace app::snapshot {
+
+void               save(const game::core::Snapshot& snapshot) noexcept;
+void               clear() noexcept;
+[[nodiscard]] bool restore(game::core::Snapshot& snapshot) noexcept;
+
+}    // namespace app::snapshot
+
+#endif    //ESP_REFLEX_APP_SNAPSHOT_HPP
@@ -0,0 +1,312 @@
+#ifndef ESP_REFLEX_APP_TIMER_WHEEL_HPP
+#define ESP_REFLEX_APP_TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace app {
+
+/**
+ * @brief Fixed capacity hierarchical timer wheel.
+ *
+ * Three levels of 64 slots, each slot of a level spans a whole turn of the
+ * level below, so with a tick of 1 ms timers up to 262 s ahead are held. A
+ * timer is linked into one slot, scheduling and cancelling are constant time
+ * and a slot of a higher level is cascaded down once when its time comes.
+ * Occupancy bitmaps find the next tick with work in a few instructions, so the
+ * owner can sleep until then instead of ticking through empty slots.
+ *
+ * @tparam Capacity The maximum number of pending timers.
+ * @tparam TickUs The resolution, a timer never fires before its due time and
+ * at most one tick after it.
+ */
+template<size_t Capacity, int64_t TickUs>
+class TimerWheel {
+  static_assert(Capacity > 0 && Capacity < 255, "Handles must fit into a byte");
+  static_assert(TickUs > 0);
+
+public:
+  using Handle = uint8_t;
+
+  static constexpr Handle  no_timer = std::numeric_limits<Handle>::max();
+  static constexpr int64_t never    = std::numeric_limits<int64_t>::max();
+
+  TimerWheel() noexcept {
+    reset(0);
+  }
+
+  /**
+   * @brief Drops all timers and restarts the wheel at the given time.
+   */
+  void reset(const int64_t now_us) noexcept {
+    m_heads.fill(no_timer);
+    m_occupied = {};
+    m_tick     = now_us / TickUs;
+    m_size     = 0;
+
+    for (size_t i = 0; i < Capacity; ++i) {
+      m_nodes[i].next = i + 1 < Capacity ? static_cast<Handle>(i + 1)
+                                         : no_timer;
+      m_nodes[i].slot = no_slot;
+    }
+    m_free = 0;
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return m_size == 0;
+  }
+
+  /**
+   * @brief Adds a timer, due times in the past fire on the next tick.
+   *
+   * @param due_us When the timer is due.
+   * @param tag Handed back when the timer fires.
+   * @return The handle to cancel the timer with, `no_timer` if the wheel is
+   * full.
+   */
+  [[nodiscard]] Handle schedule(const int64_t due_us,
+                                const uint8_t tag) noexcept {
+    if (m_free == no_timer) {
+      return no_timer;
+    }
+
+    const Handle handle = m_free;
+    Node&        node   = m_nodes[handle];
+    m_free              = node.next;
+
+    node.due_us = due_us;
+    node.tag    = tag;
+    insert(handle, m_tick + 1);
+    ++m_size;
+
+    return handle;
+  }
+
+  /**
+   * @brief Removes a pending timer, does nothing for `no_timer` or a timer
+   * that already fired.
+   */
+  void cancel(const Handle handle) noexcept {
+    if (handle >= Capacity || m_nodes[handle].slot == no_slot) {
+      return;
+    }
+
+    unlink(handle);
+    release(handle);
+  }
+
+  /**
+   * @brief Fires all timers due up to the given time in due order, one tick
+   * apart at least.
+   *
+   * @param now_us The current time.
+   * @param on_expired Called with the tag and the due time of every fired
+   * timer, may schedule new timers.
+   */
+  template<typename OnExpired>
+  void advance(const int64_t now_us, OnExpired&& on_expired) noexcept {
+    const int64_t target = now_us / TickUs;
+
+    while (m_size > 0) {
+      const int64_t tick = get_next_tick();
+      if (tick > target) {
+        break;
+      }
+
+      m_tick = tick;
+      cascade();
+      expire(on_expired);
+    }
+
+    m_tick = std::max(m_tick, target);
+  }
+
+  /**
+   * @brief Returns the time `advance` has work next, `never` if no timer is
+   * pending. May be earlier than the next due timer when a slot has to be
+   * cascaded.
+   */
+  [[nodiscard]] int64_t next_due_us() const noexcept {
+    return m_size > 0 ? get_next_tick() * TickUs : never;
+  }
+
+private:
+  static constexpr size_t   level_count = 3;
+  static constexpr uint32_t slot_bits   = 6;
+  static constexpr size_t   slot_count  = size_t {1} << slot_bits;
+  static constexpr int64_t  slot_mask   = int64_t {slot_count} - 1;
+  static constexpr uint8_t  no_slot     = std::numeric_limits<uint8_t>::max();
+
+  // Ticks ahead that the highest level can hold
+  static constexpr int64_t span = int64_t {1} << (slot_bits * level_count);
+
+  struct Node {
+    int64_t due_us;
+    Handle  prev;
+    Handle  next;
+    uint8_t slot;    // level * slot_count + slot index, `no_slot` when free
+    uint8_t tag;
+  };
+
+  [[nodiscard]] static constexpr uint32_t
+  get_shift(const size_t level) noexcept {
+    return slot_bits * static_cast<uint32_t>(level);
+  }
+
+  [[nodiscard]] static constexpr size_t
+  get_index(const int64_t tick, const size_t level) noexcept {
+    return static_cast<size_t>((tick >> get_shift(level)) & slot_mask);
+  }
+
+  /**
+   * @brief Returns the distance from `from` to the next occupied slot of a
+   * level, 1 for `from + 1` up to slot_count for `from` itself.
+   */
+  [[nodiscard]] int64_t get_distance(const size_t  level,
+                                     const int64_t from) const noexcept {
+    const auto rotation = static_cast<int>((from + 1) & slot_mask);
+    return 1 + std::countr_zero(std::rotr(m_occupied[level], rotation));
+  }
+
+  [[nodiscard]] int64_t get_next_tick() const noexcept {
+    int64_t next = never;
+
+    for (size_t level = 0; level < level_count; ++level) {
+      if (m_occupied[level] == 0) {
+        continue;
+      }
+
+      // A slot of a higher level is due when its first tick comes up
+      const int64_t block = m_tick >> get_shift(level);
+      next = std::min(next, (block + get_distance(level, block))
+                            << get_shift(level));
+    }
+
+    return next;
+  }
+
+  /**
+   * @brief Links a timer into the slot for its due time.
+   *
+   * @param min_tick The earliest tick the timer may fire on.
+   */
+  void insert(const Handle handle, const int64_t min_tick) noexcept {
+    Node& node = m_nodes[handle];
+
+    const int64_t due_tick = std::max((node.due_us + TickUs - 1) / TickUs,
+                                      min_tick);
+    const int64_t delta    = due_tick - m_tick;
+
+    size_t level = 0;
+    while (level + 1 < level_count &&
+           delta >= int64_t {1} << get_shift(level + 1)) {
+      ++level;
+    }
+
+    // Timers beyond the last level are parked in it and cascaded again
+    const int64_t tick = delta < span ? due_tick : m_tick + span - 1;
+    link(handle, level, get_index(tick, level));
+  }
+
+  void link(const Handle handle,
+            const size_t level,
+            const size_t index) noexcept {
+    const size_t slot = level * slot_count + index;
+    Node&        node = m_nodes[handle];
+
+    node.slot = static_cast<uint8_t>(slot);
+    node.prev = no_timer;
+    node.next = m_heads[slot];
+    if (node.next != no_timer) {
+      m_nodes[node.next].prev = handle;
+    }
+
+    m_heads[slot]      = handle;
+    m_occupied[level] |= uint64_t {1} << index;
+  }
+
+  void unlink(const Handle handle) noexcept {
+    const Node&  node = m_nodes[handle];
+    const size_t slot = node.slot;
+
+    if (node.prev != no_timer) {
+      m_nodes[node.prev].next = node.next;
+    } else {
+      m_heads[slot] = node.next;
+    }
+    if (node.next != no_timer) {
+      m_nodes[node.next].prev = node.prev;
+    }
+
+    if (m_heads[slot] == no_timer) {
+      m_occupied[slot / slot_count] &= ~(uint64_t {1} << (slot % slot_count));
+    }
+  }
+
+  void release(const Handle handle) noexcept {
+    m_nodes[handle].slot = no_slot;
+    m_nodes[handle].next = m_free;
+    m_free               = handle;
+    --m_size;
+  }
+
+  /**
+   * @brief Unlinks all timers of a slot and returns the first of them.
+   */
+  [[nodiscard]] Handle take(const size_t level, const size_t index) noexcept {
+    const size_t slot  = level * slot_count + index;
+    const Handle first = m_heads[slot];
+
+    m_heads[slot]      = no_timer;
+    m_occupied[level] &= ~(uint64_t {1} << index);
+    return first;
+  }
+
+  /**
+   * @brief Moves the timers of the higher level slots that start at the
+   * current tick down, the highest level first.
+   */
+  void cascade() noexcept {
+    for (size_t level = level_count - 1; level > 0; --level) {
+      const int64_t below = (int64_t {1} << get_shift(level)) - 1;
+      if ((m_tick & below) != 0) {
+        continue;
+      }
+
+      Handle handle = take(level, get_index(m_tick, level));
+      while (handle != no_timer) {
+        const Handle next = m_nodes[handle].next;
+        insert(handle, m_tick);
+        handle = next;
+      }
+    }
+  }
+
+  template<typename OnExpired>
+  void expire(OnExpired& on_expired) noexcept {
+    Handle handle = take(0, get_index(m_tick, 0));
+    while (handle != no_timer) {
+      const Node   node = m_nodes[handle];
+      const Handle next = node.next;
+
+      release(handle);
+      on_expired(node.tag, node.due_us);
+      handle = next;
+    }
+  }
+
+  std::array<Node, Capacity>                   m_nodes    = {};
+  std::array<Handle, level_count * slot_count> m_heads    = {};
+  std::array<uint64_t, level_count>            m_occupied = {};
+  int64_t                                      m_tick     = 0;
+  size_t                                       m_size     = 0;
+  Handle                                       m_free     = no_timer;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_TIMER_WHEEL_HPP
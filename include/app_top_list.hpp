@@ -0,0 +1,64 @@
+#ifndef ESP_REFLEX_APP_TOP_LIST_HPP
+#define ESP_REFLEX_APP_TOP_LIST_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+namespace app {
+
+/**
+ * @brief Fixed capacity list of the best items seen, best first.
+ *
+ * Insertion sort into a small array, an item that does not make the list is
+ * rejected with one comparison against the last one.
+ *
+ * @tparam Better Strict ordering, true if the first item ranks above the
+ * second.
+ */
+template<typename Item, size_t Capacity, typename Better>
+class TopList {
+  static_assert(Capacity > 0);
+
+public:
+  [[nodiscard]] size_t size() const noexcept {
+    return m_size;
+  }
+
+  [[nodiscard]] std::span<const Item> items() const noexcept {
+    return std::span(m_items).first(m_size);
+  }
+
+  void clear() noexcept {
+    m_size = 0;
+  }
+
+  /**
+   * @brief Adds an item if it ranks among the best, the last item drops out
+   * of a full list.
+   *
+   * @return Whether the item was added.
+   */
+  bool insert(const Item& item) noexcept {
+    if (m_size == Capacity && !Better {}(item, m_items[m_size - 1])) {
+      return false;
+    }
+
+    size_t index = m_size < Capacity ? m_size++ : Capacity - 1;
+    while (index > 0 && Better {}(item, m_items[index - 1])) {
+      m_items[index] = m_items[index - 1];
+      --index;
+    }
+    m_items[index] = item;
+
+    return true;
+  }
+
+private:
+  std::array<Item, Capacity> m_items = {};
+  size_t                     m_size  = 0;
+};
+
+}    // namespace app
+
+#endif    //ESP_REFLEX_APP_TOP_LIST_HPP
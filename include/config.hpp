@@ -2,6 +2,7 @@
 #define ESP_REFLEX_CONFIG_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
 namespace config {
@@ -12,14 +13,132 @@ constexpr inline uint32_t min_delay = 10;
 
 namespace config::game {
 
-constexpr inline unsigned int input_queue_size      = 10;
-constexpr inline unsigned int input_queue_item_size = sizeof(uint8_t);
-constexpr inline uint8_t      max_score             = 99;
-constexpr inline uint8_t      game_time             = 30;
-constexpr inline uint32_t     game_wait_for_input   = 50;
+// How the targets of a game are chosen
+enum class TargetMode : uint8_t {
+  Live,         // rolled after every hit, independently for each player
+  Bag,          // pre-generated shuffled bags, every target equally often
+  Identical,    // one pre-generated bag sequence shared by both players
+  Mirrored,     // like Identical, left and right column swapped for player 2
+  Adaptive      // rolled after every hit, weighted by earlier reaction times
+};
+
+// The rules of the game, each mode is registered with the game core
+enum class Mode : uint8_t {
+  Classic,    // a hit scores and moves the target on
+  Penalty     // like Classic, a press on an unlit button costs a point
+};
+
+// How many buttons of each player are lit at once
+enum class LightMode : uint8_t {
+  Single,    // one target
+  All,       // `lit_targets` targets, each scores, a new set once all are hit
+  Decoy      // one target and `lit_targets` - 1 decoys that cost a point
+};
+
+constexpr inline unsigned int input_queue_size = 10;
+constexpr inline size_t       max_deadlines    = 8;
+constexpr inline uint8_t      max_score        = 99;
+constexpr inline uint8_t      game_time        = 30;
+constexpr inline uint8_t      tenths_below_s   = 10;
+constexpr inline Mode         mode             = Mode::Classic;
+constexpr inline uint8_t      miss_penalty     = 1;
+constexpr inline TargetMode   target_mode      = TargetMode::Live;
+constexpr inline LightMode    light_mode       = LightMode::Single;
+constexpr inline uint8_t      lit_targets      = 3;
+constexpr inline uint8_t      decoy_penalty    = 1;
+
+// A hit should light the next target within this time of the press, the game
+// warns on the log when the 99th percentile of a game is above it
+constexpr inline uint32_t feedback_budget_us = 3000;
+
+// Show the mean reaction time of each player in hundredths of a second on
+// their score display at the end of the end pattern
+constexpr inline bool show_reaction_time = false;
+
+// Difficulty knob of the Adaptive target mode in percent. Positive values
+// light targets that took longer than average to hit more often, negative
+// values less often, 0 keeps the choice uniform.
+constexpr inline int32_t adaptive_bias = 100;
+
+// Every lit target moves on by itself when it is not hit in time. The time to
+// hit starts at `expiry_start_ms` and shrinks by `expiry_step_ms` per point
+// down to `expiry_min_ms`, a target that expires costs `expiry_penalty`
+// points. Expiries are kept in a timer wheel with a tick of `expiry_tick_us`.
+constexpr inline bool     expiry_enabled  = false;
+constexpr inline uint32_t expiry_start_ms = 2000;
+constexpr inline uint32_t expiry_step_ms  = 15;
+constexpr inline uint32_t expiry_min_ms   = 500;
+constexpr inline uint8_t  expiry_penalty  = 1;
+constexpr inline int64_t  expiry_tick_us  = 1000;
+
+// Every game is recorded as its start and the events it was stepped with, in
+// at most `record_bytes` bytes, and logged after the game. With `replay_check`
+// the firmware replays the record right away and logs whether it matches.
+constexpr inline size_t record_bytes = 2048;
+constexpr inline bool   replay_check = false;
+
+// With `resume_enabled` the running game is kept in RTC memory after every
+// frame. After a crash, a watchdog or a brownout the board skips the check
+// pattern and goes on with the game, at most `max_resumes` times per game.
+constexpr inline bool    resume_enabled = true;
+constexpr inline uint8_t max_resumes    = 2;
 
 }    // namespace config::game
 
+namespace config::input {
+
+// Sample the native button pins with a hardware timer instead of edge
+// interrupts. The mode is set once at init, input::set_mode can switch it at
+// runtime but the firmware has no path that calls it later.
+constexpr inline bool     sample_by_default   = false;
+constexpr inline uint32_t sample_rate_hz      = 2000;
+constexpr inline uint32_t sample_rate_min_hz  = 1000;
+constexpr inline uint32_t sample_rate_max_hz  = 10000;
+constexpr inline uint32_t sample_debounce_us  = 2000;
+constexpr inline uint8_t  sample_timer_number = 0;
+
+}    // namespace config::input
+
+namespace config::loadgen {
+
+// Reaction time behaviour of the simulated players, from human like presses
+// down to both players mashing buttons with no delay at all, and bursts of a
+// whole input queue of presses at once
+enum class Profile : uint8_t {
+  Human,
+  Fast,
+  Spam,
+  Burst
+};
+
+// Replace the hands on the player buttons with simulated players for every
+// game, a run is reported as PASS or FAIL on the log when the game ends
+constexpr inline bool     enabled         = false;
+constexpr inline Profile  profile         = Profile::Human;
+constexpr inline uint32_t task_stack_size = 4096;
+
+}    // namespace config::loadgen
+
+namespace config::leaderboard {
+
+// The best `top_count` scores of all games are kept on the leaderboard. Every
+// score is appended to a log in the flash partition labelled `partition`, which
+// the leaderboard is rebuilt from at boot.
+constexpr inline size_t      top_count = 10;
+constexpr inline const char* partition = "scores";
+
+}    // namespace config::leaderboard
+
+namespace config::history {
+
+// The hits, reaction times and duration of every game are kept in the flash
+// partition labelled `partition`, the oldest games make room for new ones.
+// With `export_at_boot` all kept games are streamed to the log at boot.
+constexpr inline const char* partition      = "history";
+constexpr inline bool        export_at_boot = false;
+
+}    // namespace config::history
+
 namespace config::i2c {
 
 constexpr inline uint8_t i2c_sda = 21;
@@ -29,6 +148,7 @@ constexpr inline uint8_t address_game_leds   = 0x24;
 constexpr inline uint8_t address_player1_seg = 0x21;
 constexpr inline uint8_t address_time_seg    = 0x22;
 constexpr inline uint8_t address_player2_seg = 0X20;
+constexpr inline uint8_t address_buttons     = 0x23;
 
 }    // namespace config::i2c
 
@@ -55,6 +175,10 @@ constexpr inline uint8_t player2_in_right_top           = 39;
 constexpr inline uint8_t start_in  = 13;
 constexpr inline uint8_t start_out = 15;
 
+// INTA of the button MCP23017, only used if a station has buttons on it. INTB
+// is mirrored onto it, which keeps the line off the GPIO 2 strapping pin.
+constexpr inline uint8_t buttons_int = 14;
+
 // the left column is 0 to 3 from bottom to top, the right column is 4 to 7 from bottom to top
 constexpr inline std::array<uint8_t, 8> player1_in = {
   player1_in_left_bottom,
@@ -115,6 +239,10 @@ constexpr inline uint8_t seg_left_pin_e = 9;//9
 constexpr inline uint8_t seg_left_pin_f = 13;//
 constexpr inline uint8_t seg_left_pin_g = 12;//
 
+// the spare pin next to each digit drives its decimal point
+constexpr inline uint8_t seg_left_pin_dp  = 11;
+constexpr inline uint8_t seg_right_pin_dp = 0;
+
 // the left column is 0 to 3 from bottom to top, the right column is 4 to 7 from bottom to top
 constexpr inline std::array<uint8_t, 8> player1_out = {
   player1_out_left_bottom,
@@ -155,6 +283,40 @@ constexpr inline std::array<uint8_t, 7> seg_right_pins = {seg_right_pin_a,
                                                           seg_right_pin_f,
                                                           seg_right_pin_g};
 
+// Button ids of the pins of the button MCP23017, they follow GPIO 0 to 39 so
+// the game tells an expander press from a native one. Pin 0 of port A is id
+// 40 and pin 7 of port B is id 55, ordered like the `player1_in` arrays.
+constexpr inline uint8_t buttons_first_id = 40;
+
+constexpr inline std::array<uint8_t, 8> port_a_in = {40, 41, 42, 43,
+                                                     44, 45, 46, 47};
+constexpr inline std::array<uint8_t, 8> port_b_in = {48, 49, 50, 51,
+                                                     52, 53, 54, 55};
+
 }    // namespace config::mcp
 
+namespace config::stations {
+
+constexpr inline size_t targets_per_station = 8;
+
+// Everything that belongs to one player, the targets are ordered like the pin
+// arrays above, 0 to 3 the left column and 4 to 7 the right column from bottom
+// to top
+struct Station {
+  std::array<uint8_t, targets_per_station> buttons_in;    // button ids
+  std::array<uint8_t, targets_per_station> leds_out;      // player LED pins
+  uint8_t score_display;    // 0 is the player 1 display, 1 the player 2 one
+};
+
+// One entry per player, the game engine sizes all player state from this. A
+// station reads its buttons from the native GPIOs with `config::gpio` arrays
+// or from the button MCP23017 with `config::mcp::port_a_in` and `port_b_in`,
+// both kinds can be mixed.
+constexpr inline std::array<Station, 2> stations = {{
+  {config::gpio::player1_in, config::mcp::player1_out, 0},
+  {config::gpio::player2_in, config::mcp::player2_out, 1},
+}};
+
+}    // namespace config::stations
+
 #endif    //ESP_REFLEX_CONFIG_HPP
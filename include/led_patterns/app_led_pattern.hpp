@@ -1,22 +1,226 @@
 #ifndef ESP_REFLEX_APP_LED_PATTERN_HPP
 #define ESP_REFLEX_APP_LED_PATTERN_HPP
 
+#include "config.hpp"
+#include "global.hpp"
+
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <span>
+
+// A pattern is a list of frames, each the state of every output it drives:
+// the 16 pins of the four expanders and the start LED. The frames are built at
+// compile time from the pin constants of `config`, a stage starts from the
+// frame before it like the outputs do, so a stage plays back as at most one
+// port write per expander that changed and one write of the start LED.
 
 namespace app::led_pattern {
 
-using StageFn         = void (*)() noexcept;
 using DelayAfterStage = uint32_t;
 
+// The expanders in the order of `Output`, the start LED is not one of them
+constexpr inline size_t port_count = 4;
+
+// What a port shows on top of its pins, filled in when the stage plays
+enum class Fill : uint8_t {
+  None,
+  Score,       // a score display shows the final score of its player
+  Reaction,    // a score display shows the mean reaction time of its player
+               // in hundredths of a second
+  Random       // the player LED port lights one random target per player
+};
+
+/**
+ * @brief Returns the pins of a 7-segment expander that show two digits.
+ *
+ * @param tens The digit of the left display, blank above 9.
+ * @param ones The digit of the right display, blank above 9.
+ * @param decimal_point Lights the decimal point after the left digit.
+ */
+[[nodiscard]] constexpr uint16_t get_segment_port(
+const uint8_t tens,
+const uint8_t ones,
+const bool    decimal_point) noexcept {
+  // Segments a to g from bit 0 to 6
+  constexpr std::array<uint8_t, 10> digits =
+  {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F};
+
+  const uint32_t left  = tens < digits.size() ? digits[tens] : 0U;
+  const uint32_t right = ones < digits.size() ? digits[ones] : 0U;
+
+  uint32_t port = 0;
+  for (size_t i = 0; i < 7; ++i) {
+    port |= ((left >> i) & 1U) << config::mcp::seg_left_pins[i];
+    port |= ((right >> i) & 1U) << config::mcp::seg_right_pins[i];
+  }
+  if (decimal_point) {
+    port |= 1U << config::mcp::seg_left_pin_dp;
+  }
+
+  return static_cast<uint16_t>(port);
+}
+
+/**
+ * @brief Returns the pins of a 7-segment expander that show a number, 99 for
+ * larger numbers.
+ */
+[[nodiscard]] constexpr uint16_t get_number_port(uint8_t number) noexcept {
+  if (number > 99) {
+    number = 99;
+  }
+  return get_segment_port(static_cast<uint8_t>(number / 10),
+                          static_cast<uint8_t>(number % 10),
+                          false);
+}
+
+[[nodiscard]] constexpr uint16_t
+get_pins(const std::span<const uint8_t> pins) noexcept {
+  uint32_t mask = 0;
+  for (const uint8_t pin : pins) {
+    mask |= 1U << pin;
+  }
+  return static_cast<uint16_t>(mask);
+}
+
+/**
+ * @brief Returns the two LEDs of a row of a player on the player LED port.
+ */
+[[nodiscard]] constexpr uint16_t get_row(const Player player,
+                                         const Row    row) noexcept {
+  const config::stations::Station& station =
+  config::stations::stations[static_cast<size_t>(player)];
+
+  // The left column holds targets 0 to 3 and the right column 4 to 7, each
+  // from bottom to top
+  const auto bottom = static_cast<size_t>(row);
+  return get_pins(std::array {station.leds_out[bottom],
+                              station.leds_out[bottom + 4]});
+}
+
+/**
+ * @brief Returns the player whose score a 7-segment display shows.
+ */
+[[nodiscard]] constexpr size_t
+get_display_player(const SegmentDisplay display) noexcept {
+  for (size_t player = 0; player < config::stations::stations.size();
+       ++player) {
+    if (config::stations::stations[player].score_display ==
+        static_cast<uint8_t>(display)) {
+      return player;
+    }
+  }
+  return config::stations::stations.size();
+}
+
+/**
+ * @brief Returns the player whose score the 7-segment display on a port shows,
+ * `stations.size()` for the player LED port and ports past the last one.
+ *
+ * @param port The port, in the order of `Output`.
+ */
+[[nodiscard]] constexpr size_t get_port_player(const size_t port) noexcept {
+  // The displays follow the players port in the order of `Output`
+  if (port == static_cast<size_t>(Output::Players) || port >= port_count) {
+    return config::stations::stations.size();
+  }
+  return get_display_player(static_cast<SegmentDisplay>(port - 1));
+}
+
+static_assert(get_port_player(static_cast<size_t>(Output::Players)) ==
+              config::stations::stations.size());
+static_assert(get_port_player(port_count) ==
+              config::stations::stations.size());
+
+/**
+ * @brief The outputs of a stage.
+ *
+ * The changes read like the calls on `controller::gpio` they replace, each
+ * applies to the frame instead of the pins.
+ */
+struct Frame {
+  std::array<uint16_t, port_count> ports;
+  std::array<Fill, port_count>     fills;
+  bool                             start;
+
+  [[nodiscard]] constexpr bool operator==(const Frame&) const noexcept =
+  default;
+
+  constexpr void turn_on(const uint8_t pin, const Output output) noexcept {
+    get_port(output) = static_cast<uint16_t>(get_port(output) | 1U << pin);
+  }
+
+  constexpr void turn_on_row(const Player player, const Row row) noexcept {
+    get_port(Output::Players) =
+    static_cast<uint16_t>(get_port(Output::Players) | get_row(player, row));
+  }
+
+  constexpr void turn_off_row(const Player player, const Row row) noexcept {
+    get_port(Output::Players) =
+    static_cast<uint16_t>(get_port(Output::Players) & ~get_row(player, row));
+  }
+
+  constexpr void turn_on_start() noexcept {
+    start = true;
+  }
+
+  constexpr void display_segment_number(const uint8_t        number,
+                                        const SegmentDisplay display) noexcept {
+    show(display, get_number_port(number), Fill::None);
+  }
+
+  constexpr void turn_off_segment(const SegmentDisplay display) noexcept {
+    show(display, 0, Fill::None);
+  }
+
+  constexpr void display_score(const SegmentDisplay display) noexcept {
+    show(display, 0, Fill::Score);
+  }
+
+  constexpr void display_reaction(const SegmentDisplay display) noexcept {
+    show(display, 0, Fill::Reaction);
+  }
+
+  // Every play of the stage lights other targets
+  constexpr void turn_on_random_targets() noexcept {
+    fills[static_cast<size_t>(Output::Players)] = Fill::Random;
+  }
+
+private:
+  [[nodiscard]] constexpr uint16_t& get_port(const Output output) noexcept {
+    return ports[static_cast<size_t>(output)];
+  }
+
+  constexpr void show(const SegmentDisplay display,
+                      const uint16_t       port,
+                      const Fill           fill) noexcept {
+    // The displays follow the players port in the order of `Output`
+    const size_t index = static_cast<size_t>(display) + 1;
+    ports[index]       = port;
+    fills[index]       = fill;
+  }
+};
+
+static_assert(static_cast<size_t>(Output::SegPlayer1) ==
+              static_cast<size_t>(SegmentDisplay::Player1) + 1);
+static_assert(static_cast<size_t>(Output::SegTimer) ==
+              static_cast<size_t>(SegmentDisplay::Timer) + 1);
+static_assert(static_cast<size_t>(Output::Gpio) == port_count);
+
+// A frame with every output off
+constexpr inline Frame off = {};
+
+struct Stage {
+  Frame           frame;
+  DelayAfterStage delay_ms;
+};
+
 }    // namespace app::led_pattern
 
 namespace app {
 
 template<size_t StageCount>
-using LedPattern =
-std::array<std::pair<led_pattern::StageFn, led_pattern::DelayAfterStage>,
-           StageCount>;
+using LedPattern = std::array<led_pattern::Stage, StageCount>;
 
 }    // namespace app
 
@@ -1,37 +1,44 @@
 #ifndef ESP_REFLEX_APP_LED_PATTERN_CHECK_HPP
 #define ESP_REFLEX_APP_LED_PATTERN_CHECK_HPP
 
-#include "app_controller.hpp"
 #include "config.hpp"
 #include "global.hpp"
 #include "led_patterns/app_led_pattern.hpp"
 
-#include <cstddef>
 #include <cstdint>
 
 namespace app::led_pattern {
 
-constexpr inline LedPattern<1> check = {
-  {{[]() noexcept {
-      for (const uint8_t pin : config::mcp::player1_out) {
-        controller::gpio::turn_on(pin, Output::Players);
-      }
-      for (const uint8_t pin : config::mcp::player2_out) {
-        controller::gpio::turn_on(pin, Output::Players);
-      }
-      for (const uint8_t pin : config::mcp::seg_left_pins) {
-        controller::gpio::turn_on(pin, Output::SegPlayer1);
-        controller::gpio::turn_on(pin, Output::SegPlayer2);
-        controller::gpio::turn_on(pin, Output::SegTimer);
-      }
-      for (const uint8_t pin : config::mcp::seg_right_pins) {
-        controller::gpio::turn_on(pin, Output::SegPlayer1);
-        controller::gpio::turn_on(pin, Output::SegPlayer2);
-        controller::gpio::turn_on(pin, Output::SegTimer);
-      }
-      controller::gpio::turn_on(config::gpio::start_out, Output::Gpio);
-    },
-    3000}}};
+constexpr inline LedPattern<1> check = []() noexcept {
+  Frame frame = off;
+
+  for (const uint8_t pin : config::mcp::player1_out) {
+    frame.turn_on(pin, Output::Players);
+  }
+  for (const uint8_t pin : config::mcp::player2_out) {
+    frame.turn_on(pin, Output::Players);
+  }
+  for (const uint8_t pin : config::mcp::seg_left_pins) {
+    frame.turn_on(pin, Output::SegPlayer1);
+    frame.turn_on(pin, Output::SegPlayer2);
+    frame.turn_on(pin, Output::SegTimer);
+  }
+  for (const uint8_t pin : config::mcp::seg_right_pins) {
+    frame.turn_on(pin, Output::SegPlayer1);
+    frame.turn_on(pin, Output::SegPlayer2);
+    frame.turn_on(pin, Output::SegTimer);
+  }
+  frame.turn_on_start();
+
+  return LedPattern<1> {{{frame, 3000}}};
+}();
+
+// Every LED but the decimal points, one write per expander
+static_assert(check[0].frame.ports[0] ==
+              (get_pins(config::mcp::player1_out) |
+               get_pins(config::mcp::player2_out)));
+static_assert(check[0].frame.ports[1] == get_segment_port(8, 8, false));
+static_assert(check[0].frame.ports[3] == get_number_port(88));
 
 }    // namespace app::led_pattern
 
@@ -1,210 +1,207 @@
 #ifndef ESP_REFLEX_APP_LED_PATTERN_END_HPP
 #define ESP_REFLEX_APP_LED_PATTERN_END_HPP
 
-#include "app_controller.hpp"
-#include "app_game.hpp"
 #include "config.hpp"
 #include "global.hpp"
 #include "led_patterns/app_led_pattern.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 namespace app::led_pattern {
 
-constexpr inline LedPattern<12> end = {
-  {{[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      controller::gpio::display_segment_number(score_p1,
-                                               SegmentDisplay::Player1);
-      controller::gpio::display_segment_number(score_p2,
-                                               SegmentDisplay::Player2);
-
-      controller::gpio::display_segment_number(0, SegmentDisplay::Timer);
-    },
-    300},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_on_row(Player::Player1, Row::Bottom);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player1);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_on_row(Player::Player2, Row::Bottom);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player2);
-      } else {
-        controller::gpio::turn_on_row(Player::Player1, Row::Bottom);
-        controller::gpio::turn_on_row(Player::Player2, Row::Bottom);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player1);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player2);
-      }
-
-      controller::gpio::turn_off_segment(SegmentDisplay::Timer);
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_on_row(Player::Player1, Row::MiddleBottom);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_on_row(Player::Player2, Row::MiddleBottom);
-      } else {
-        controller::gpio::turn_on_row(Player::Player1, Row::MiddleBottom);
-        controller::gpio::turn_on_row(Player::Player2, Row::MiddleBottom);
-      }
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_on_row(Player::Player1, Row::MiddleTop);
-        controller::gpio::display_segment_number(score_p1,
-                                                 SegmentDisplay::Player1);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_on_row(Player::Player2, Row::MiddleTop);
-        controller::gpio::display_segment_number(score_p2,
-                                                 SegmentDisplay::Player2);
-      } else {
-        controller::gpio::turn_on_row(Player::Player1, Row::MiddleTop);
-        controller::gpio::turn_on_row(Player::Player2, Row::MiddleTop);
-        controller::gpio::display_segment_number(score_p1,
-                                                 SegmentDisplay::Player1);
-        controller::gpio::display_segment_number(score_p2,
-                                                 SegmentDisplay::Player2);
-      }
-
-      controller::gpio::display_segment_number(0, SegmentDisplay::Timer);
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_on_row(Player::Player1, Row::Top);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_on_row(Player::Player2, Row::Top);
-      } else {
-        controller::gpio::turn_on_row(Player::Player1, Row::Top);
-        controller::gpio::turn_on_row(Player::Player2, Row::Top);
-      }
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_off_row(Player::Player1, Row::Bottom);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player1);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_off_row(Player::Player2, Row::Bottom);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player2);
-      } else {
-        controller::gpio::turn_off_row(Player::Player1, Row::Bottom);
-        controller::gpio::turn_off_row(Player::Player2, Row::Bottom);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player1);
-        controller::gpio::turn_off_segment(SegmentDisplay::Player2);
-      }
-
-      controller::gpio::turn_off_segment(SegmentDisplay::Timer);
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_off_row(Player::Player1, Row::MiddleBottom);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_off_row(Player::Player2, Row::MiddleBottom);
-      } else {
-        controller::gpio::turn_off_row(Player::Player1, Row::MiddleBottom);
-        controller::gpio::turn_off_row(Player::Player2, Row::MiddleBottom);
-      }
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_off_row(Player::Player1, Row::MiddleTop);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_off_row(Player::Player2, Row::MiddleTop);
-      } else {
-        controller::gpio::turn_off_row(Player::Player1, Row::MiddleTop);
-        controller::gpio::turn_off_row(Player::Player2, Row::MiddleTop);
-      }
-
-      controller::gpio::display_segment_number(score_p1,
-                                               SegmentDisplay::Player1);
-      controller::gpio::display_segment_number(score_p2,
-                                               SegmentDisplay::Player2);
-
-      controller::gpio::display_segment_number(0, SegmentDisplay::Timer);
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_off_row(Player::Player1, Row::Top);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_off_row(Player::Player2, Row::Top);
-      } else {
-        controller::gpio::turn_off_row(Player::Player1, Row::Top);
-        controller::gpio::turn_off_row(Player::Player2, Row::Top);
-      }
-    },
-    150},
-   {[]() noexcept {
-      const auto [score_p1, score_p2] = app::game::get_last_final_score();
-
-      controller::gpio::turn_off_segment(SegmentDisplay::Timer);
-
-      if (score_p1 > score_p2) {
-        controller::gpio::turn_on(config::mcp::seg_left_pin_f,
-                                  Output::SegTimer);
-        controller::gpio::turn_on(config::mcp::seg_left_pin_e,
-                                  Output::SegTimer);
-      } else if (score_p2 > score_p1) {
-        controller::gpio::turn_on(config::mcp::seg_right_pin_b,
-                                  Output::SegTimer);
-        controller::gpio::turn_on(config::mcp::seg_right_pin_c,
-                                  Output::SegTimer);
-      } else {
-        controller::gpio::turn_on(config::mcp::seg_left_pin_f,
-                                  Output::SegTimer);
-        controller::gpio::turn_on(config::mcp::seg_left_pin_e,
-                                  Output::SegTimer);
-        controller::gpio::turn_on(config::mcp::seg_right_pin_b,
-                                  Output::SegTimer);
-        controller::gpio::turn_on(config::mcp::seg_right_pin_c,
-                                  Output::SegTimer);
-      }
-
-      controller::gpio::turn_on_row(Player::Player1, Row::MiddleBottom);
-      controller::gpio::turn_on_row(Player::Player2, Row::MiddleBottom);
-      controller::gpio::turn_on_row(Player::Player1, Row::MiddleTop);
-      controller::gpio::turn_on_row(Player::Player2, Row::MiddleTop);
-    },
-    900},
-   {[]() noexcept {
-      controller::gpio::turn_off_row(Player::Player1, Row::MiddleBottom);
-      controller::gpio::turn_off_row(Player::Player2, Row::MiddleBottom);
-      controller::gpio::turn_off_row(Player::Player1, Row::MiddleTop);
-      controller::gpio::turn_off_row(Player::Player2, Row::MiddleTop);
-      controller::gpio::turn_on_row(Player::Player1, Row::Top);
-      controller::gpio::turn_on_row(Player::Player2, Row::Top);
-      controller::gpio::turn_on_row(Player::Player1, Row::Bottom);
-      controller::gpio::turn_on_row(Player::Player2, Row::Bottom);
-    },
-    900},
-   {[]() noexcept {
-      controller::gpio::turn_off_row(Player::Player1, Row::Top);
-      controller::gpio::turn_off_row(Player::Player2, Row::Top);
-      controller::gpio::turn_off_row(Player::Player1, Row::Bottom);
-      controller::gpio::turn_off_row(Player::Player2, Row::Bottom);
-    },
-    900}}
-};
+// The stations with the best final score, a bit per station in the order of
+// `config::stations`. More than one bit is a tie.
+using Winners = uint8_t;
+
+static_assert(config::stations::stations.size() <= 8,
+              "Winners holds a bit per station");
+
+// The final scores of the stations, in the order of `config::stations`
+using Scores = std::array<uint8_t, config::stations::stations.size()>;
+
+namespace impl {
+
+// Every station, for the changes that apply to winners and losers alike
+constexpr inline Winners everyone =
+static_cast<Winners>((1U << config::stations::stations.size()) - 1);
+
+/**
+ * @brief Applies a change to the player and the score display of each winner.
+ */
+template<typename Change>
+constexpr void for_winners(const Winners winners, Change&& change) noexcept {
+  for (size_t station = 0; station < config::stations::stations.size();
+       ++station) {
+    if ((winners >> station & 1U) != 0) {
+      change(static_cast<Player>(station),
+             static_cast<SegmentDisplay>(
+             config::stations::stations[station].score_display));
+    }
+  }
+}
+
+/**
+ * @brief Builds the end pattern for one outcome of the game.
+ *
+ * The final scores are shown, then the rows of the winners climb up and down
+ * while their scores blink, the timer points to the winners and all rows
+ * flash. With `show_reaction_time` the score displays show the mean reaction
+ * times at the end.
+ */
+[[nodiscard]] constexpr LedPattern<13>
+make_end(const Winners winners) noexcept {
+  constexpr std::array<Row, 4> rows = {Row::Bottom,
+                                       Row::MiddleBottom,
+                                       Row::MiddleTop,
+                                       Row::Top};
+
+  LedPattern<13> pattern = {};
+  Frame          frame   = off;
+
+  const auto display_scores = [&frame]() noexcept {
+    for_winners(everyone, [&frame](Player, const SegmentDisplay display) {
+      frame.display_score(display);
+    });
+  };
+
+  display_scores();
+  frame.display_segment_number(0, SegmentDisplay::Timer);
+  pattern[0] = {frame, 300};
+
+  // Up, the score of the winners goes dark on the first beat and comes back
+  // on the third, the timer with it
+  for (size_t beat = 0; beat < rows.size(); ++beat) {
+    for_winners(winners,
+                [&](const Player player, const SegmentDisplay display) {
+                  frame.turn_on_row(player, rows[beat]);
+                  if (beat == 0) {
+                    frame.turn_off_segment(display);
+                  } else if (beat == 2) {
+                    frame.display_score(display);
+                  }
+                });
+    if (beat == 0) {
+      frame.turn_off_segment(SegmentDisplay::Timer);
+    } else if (beat == 2) {
+      frame.display_segment_number(0, SegmentDisplay::Timer);
+    }
+    pattern[1 + beat] = {frame, 150};
+  }
+
+  // And down again, all scores come back on the third beat
+  for (size_t beat = 0; beat < rows.size(); ++beat) {
+    for_winners(winners,
+                [&](const Player player, const SegmentDisplay display) {
+                  frame.turn_off_row(player, rows[beat]);
+                  if (beat == 0) {
+                    frame.turn_off_segment(display);
+                  }
+                });
+    if (beat == 0) {
+      frame.turn_off_segment(SegmentDisplay::Timer);
+    } else if (beat == 2) {
+      display_scores();
+      frame.display_segment_number(0, SegmentDisplay::Timer);
+    }
+    pattern[5 + beat] = {frame, 150};
+  }
+
+  // The timer points to the winners, the outer digit segments on the side of
+  // their score display
+  frame.turn_off_segment(SegmentDisplay::Timer);
+  for_winners(winners, [&frame](Player, const SegmentDisplay display) {
+    if (display == SegmentDisplay::Player1) {
+      frame.turn_on(config::mcp::seg_left_pin_f, Output::SegTimer);
+      frame.turn_on(config::mcp::seg_left_pin_e, Output::SegTimer);
+    } else if (display == SegmentDisplay::Player2) {
+      frame.turn_on(config::mcp::seg_right_pin_b, Output::SegTimer);
+      frame.turn_on(config::mcp::seg_right_pin_c, Output::SegTimer);
+    }
+  });
+  for_winners(everyone, [&frame](const Player player, SegmentDisplay) {
+    frame.turn_on_row(player, Row::MiddleBottom);
+    frame.turn_on_row(player, Row::MiddleTop);
+  });
+  pattern[9] = {frame, 900};
+
+  for_winners(everyone, [&frame](const Player player, SegmentDisplay) {
+    frame.turn_off_row(player, Row::MiddleBottom);
+    frame.turn_off_row(player, Row::MiddleTop);
+    frame.turn_on_row(player, Row::Top);
+    frame.turn_on_row(player, Row::Bottom);
+  });
+  pattern[10] = {frame, 900};
+
+  for_winners(everyone, [&frame](const Player player, SegmentDisplay) {
+    frame.turn_off_row(player, Row::Top);
+    frame.turn_off_row(player, Row::Bottom);
+  });
+  pattern[11] = {frame, 900};
+
+  if constexpr (config::game::show_reaction_time) {
+    for_winners(everyone, [&frame](Player, const SegmentDisplay display) {
+      frame.display_reaction(display);
+    });
+  }
+  pattern[12] = {frame, config::game::show_reaction_time ? 3000U : 0U};
+
+  return pattern;
+}
+
+/**
+ * @brief Builds the end pattern of every set of winners, indexed by `Winners`.
+ */
+[[nodiscard]] constexpr auto make_ends() noexcept {
+  std::array<LedPattern<13>, size_t {everyone} + 1> ends = {};
+  for (size_t winners = 1; winners < ends.size(); ++winners) {
+    ends[winners] = make_end(static_cast<Winners>(winners));
+  }
+  return ends;
+}
+
+}    // namespace impl
+
+// One pattern per set of winners, indexed by `Winners`
+constexpr inline auto end = impl::make_ends();
+
+/**
+ * @brief Returns the stations with the best of the final scores.
+ */
+[[nodiscard]] constexpr Winners get_winners(const Scores& scores) noexcept {
+  const uint8_t best = *std::ranges::max_element(scores);
+
+  Winners winners = 0;
+  for (size_t station = 0; station < scores.size(); ++station) {
+    if (scores[station] == best) {
+      winners = static_cast<Winners>(winners | 1U << station);
+    }
+  }
+  return winners;
+}
+
+/**
+ * @brief Returns the end pattern for the final scores of the stations.
+ */
+[[nodiscard]] constexpr const LedPattern<13>&
+get_end(const Scores& scores) noexcept {
+  return end[get_winners(scores)];
+}
+
+// The winner climbs alone, a tie lights every station
+static_assert(get_winners({}) == impl::everyone);
+static_assert(end[0b1][4].frame.ports[0] ==
+              get_pins(config::stations::stations[0].leds_out));
+static_assert(end[impl::everyone][4].frame.ports[0] == [] {
+  uint16_t pins = 0;
+  for (const config::stations::Station& station : config::stations::stations) {
+    pins = static_cast<uint16_t>(pins | get_pins(station.leds_out));
+  }
+  return pins;
+}());
+static_assert(end[0b1][11].frame.ports[0] == 0);
 
 }    // namespace app::led_pattern
 
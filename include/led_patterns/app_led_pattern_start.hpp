@@ -1,55 +1,51 @@
 #ifndef ESP_REFLEX_APP_LED_PATTERN_START_HPP
 #define ESP_REFLEX_APP_LED_PATTERN_START_HPP
 
-#include "app_controller.hpp"
 #include "config.hpp"
 #include "global.hpp"
 #include "led_patterns/app_led_pattern.hpp"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 namespace app::led_pattern {
 
-constexpr inline LedPattern<5> start = {
-  {{[]() noexcept {
-      controller::gpio::turn_on(config::mcp::seg_left_pin_g, Output::SegTimer);
-      controller::gpio::turn_on(config::mcp::seg_right_pin_g, Output::SegTimer);
-
-      controller::gpio::display_segment_number(5, SegmentDisplay::Player1);
-      controller::gpio::display_segment_number(5, SegmentDisplay::Player2);
-    },
-    500},
-   {[]() noexcept {
-      controller::gpio::turn_on_row(Player::Player1, Row::Bottom);
-      controller::gpio::turn_on_row(Player::Player2, Row::Bottom);
-
-      controller::gpio::display_segment_number(4, SegmentDisplay::Player1);
-      controller::gpio::display_segment_number(4, SegmentDisplay::Player2);
-    },
-    500},
-   {[]() noexcept {
-      controller::gpio::turn_on_row(Player::Player1, Row::MiddleBottom);
-      controller::gpio::turn_on_row(Player::Player2, Row::MiddleBottom);
-
-      controller::gpio::display_segment_number(3, SegmentDisplay::Player1);
-      controller::gpio::display_segment_number(3, SegmentDisplay::Player2);
-    },
-    500},
-   {[]() noexcept {
-      controller::gpio::turn_on_row(Player::Player1, Row::MiddleTop);
-      controller::gpio::turn_on_row(Player::Player2, Row::MiddleTop);
-
-      controller::gpio::display_segment_number(2, SegmentDisplay::Player1);
-      controller::gpio::display_segment_number(2, SegmentDisplay::Player2);
-    },
-    500},
-   {[]() noexcept {
-      controller::gpio::turn_on_row(Player::Player1, Row::Top);
-      controller::gpio::turn_on_row(Player::Player2, Row::Top);
-
-      controller::gpio::display_segment_number(1, SegmentDisplay::Player1);
-      controller::gpio::display_segment_number(1, SegmentDisplay::Player2);
-    },
-    500}}
-};
+// A countdown from 5 on the score displays, each beat lights the next row of
+// targets from the bottom
+constexpr inline LedPattern<5> start = []() noexcept {
+  constexpr std::array<Row, 4> rows = {Row::Bottom,
+                                       Row::MiddleBottom,
+                                       Row::MiddleTop,
+                                       Row::Top};
+
+  LedPattern<5> pattern = {};
+  Frame         frame   = off;
+
+  frame.turn_on(config::mcp::seg_left_pin_g, Output::SegTimer);
+  frame.turn_on(config::mcp::seg_right_pin_g, Output::SegTimer);
+
+  for (size_t beat = 0; beat < pattern.size(); ++beat) {
+    if (beat > 0) {
+      frame.turn_on_row(Player::Player1, rows[beat - 1]);
+      frame.turn_on_row(Player::Player2, rows[beat - 1]);
+    }
+
+    const auto count = static_cast<uint8_t>(pattern.size() - beat);
+    frame.display_segment_number(count, SegmentDisplay::Player1);
+    frame.display_segment_number(count, SegmentDisplay::Player2);
+
+    pattern[beat] = {frame, 500};
+  }
+
+  return pattern;
+}();
+
+// The last beat, which the game holds until the go, lights every target
+static_assert(start[4].frame.ports[0] ==
+              (get_pins(config::mcp::player1_out) |
+               get_pins(config::mcp::player2_out)));
+static_assert(start[4].frame.ports[1] == get_number_port(1));
 
 }    // namespace app::led_pattern
 
@@ -1,6 +1,12 @@
 #include "app_controller.hpp"
 #define MCP23017_GPIOA 0x12
+#include "app_buttons.hpp"
 #include "app_game.hpp"
+#include "app_history.hpp"
+#include "app_input.hpp"
+#include "app_leaderboard.hpp"
+#include "app_loadgen.hpp"
+#include "app_random.hpp"
 #include "config.hpp"
 #include "global.hpp"
 #include "led_patterns/app_led_pattern.hpp"
@@ -13,9 +19,11 @@
 #include <esp32-hal-gpio.h>
 #include <esp_log.h>
 #include <esp_random.h>
+#include <esp_timer.h>
 #include <hal/gpio_types.h>
 
 #include <Arduino.h>
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
@@ -47,31 +55,16 @@ namespace impl {
   return s_mcp_seg_timer;
 }
 
-[[nodiscard]] constexpr static std::array<bool, 7> get_segment_for_digit(
-uint8_t digit) noexcept {
-  switch (digit) {
-    case 0:
-      return {true, true, true, true, true, true, false};
-    case 1:
-      return {false, true, true, false, false, false, false};
-    case 2:
-      return {true, true, false, true, true, false, true};
-    case 3:
-      return {true, true, true, true, false, false, true};
-    case 4:
-      return {false, true, true, false, false, true, true};
-    case 5:
-      return {true, false, true, true, false, true, true};
-    case 6:
-      return {true, false, true, true, true, true, true};
-    case 7:
-      return {true, true, true, false, false, false, false};
-    case 8:
-      return {true, true, true, true, true, true, true};
-    case 9:
-      return {true, true, true, true, false, true, true};
+[[nodiscard]] constexpr static Output get_segment_output(
+SegmentDisplay display) noexcept {
+  switch (display) {
+    case SegmentDisplay::Player1:
+      return Output::SegPlayer1;
+    case SegmentDisplay::Player2:
+      return Output::SegPlayer2;
+    case SegmentDisplay::Timer:
     default:
-      return {false, false, false, false, false, false, false};
+      return Output::SegTimer;
   }
 }
 
@@ -80,14 +73,14 @@ static void init_gpio() {
                      GPIO_MODE_OUTPUT);
   gpio_set_level(static_cast<gpio_num_t>(config::gpio::start_out), LOW);
 
-  for (const uint8_t pin : config::gpio::player1_in) {
-    gpio_set_direction(static_cast<gpio_num_t>(pin), GPIO_MODE_INPUT);
-    gpio_set_intr_type(static_cast<gpio_num_t>(pin), GPIO_INTR_NEGEDGE);
-  }
-
-  for (const uint8_t pin : config::gpio::player2_in) {
-    gpio_set_direction(static_cast<gpio_num_t>(pin), GPIO_MODE_INPUT);
-    gpio_set_intr_type(static_cast<gpio_num_t>(pin), GPIO_INTR_NEGEDGE);
+  for (const auto& station : config::stations::stations) {
+    for (const uint8_t pin : station.buttons_in) {
+      if (!buttons::is_native(pin)) {
+        continue;
+      }
+      gpio_set_direction(static_cast<gpio_num_t>(pin), GPIO_MODE_INPUT);
+      gpio_set_intr_type(static_cast<gpio_num_t>(pin), GPIO_INTR_NEGEDGE);
+    }
   }
 
   gpio_set_direction(static_cast<gpio_num_t>(config::gpio::start_in),
@@ -100,7 +93,7 @@ static void init_gpio() {
 
 static void init_random() {
   const uint32_t seed = esp_random();    //true random from entropy
-  randomSeed(seed);
+  get_random().seed(seed);
 }
 
 static void init_i2c_devices() noexcept {
@@ -163,9 +156,92 @@ static void init_i2c_devices() noexcept {
 
 }
 
+/**
+ * @brief Returns the port value of a fill, see `led_pattern::Fill`.
+ *
+ * @param fill The fill.
+ * @param port The port it fills, in the order of `Output`.
+ */
+[[nodiscard]] static uint16_t get_fill(const led_pattern::Fill fill,
+                                       const size_t            port) noexcept {
+  switch (fill) {
+    case led_pattern::Fill::None:
+      return 0;
+    case led_pattern::Fill::Random: {
+      uint32_t pins = 0;
+      for (size_t station = 0; station < config::stations::stations.size();
+           ++station) {
+        pins |= 1U << controller::util::get_random_player_pins(
+                      static_cast<Player>(station))
+                      .pin_out;
+      }
+      return static_cast<uint16_t>(pins);
+    }
+    case led_pattern::Fill::Score:
+    case led_pattern::Fill::Reaction:
+      break;
+  }
+
+  const size_t player = led_pattern::get_port_player(port);
+  if (player >= config::stations::stations.size()) {
+    return 0;
+  }
+
+  if (fill == led_pattern::Fill::Score) {
+    return led_pattern::get_number_port(
+    app::game::get_last_final_score().at(player));
+  }
+
+  // Mean reaction time in hundredths of a second
+  const uint32_t mean_cs =
+  app::game::get_last_reaction_stats(player).mean_us / 10000;
+  return led_pattern::get_number_port(
+  static_cast<uint8_t>(std::min<uint32_t>(mean_cs, 99)));
+}
+
+/**
+ * @brief Shows a frame of a LED pattern.
+ *
+ * Only the expanders whose port value changed are written, each with one
+ * port write, and the start LED only when it changed.
+ *
+ * @param frame The frame to show.
+ * @param shown The outputs as they are, updated to the frame.
+ */
+static void show_frame(const led_pattern::Frame& frame,
+                       led_pattern::Frame&       shown) noexcept {
+  for (size_t port = 0; port < led_pattern::port_count; ++port) {
+    const auto value = static_cast<uint16_t>(
+    frame.ports[port] | get_fill(frame.fills[port], port));
+
+    if (value != shown.ports[port]) {
+      controller::gpio::write_port(value, static_cast<Output>(port));
+      shown.ports[port] = value;
+    }
+  }
+
+  if (frame.start != shown.start) {
+    if (frame.start) {
+      controller::gpio::turn_on(config::gpio::start_out, Output::Gpio);
+    } else {
+      controller::gpio::turn_off(config::gpio::start_out, Output::Gpio);
+    }
+    shown.start = frame.start;
+  }
+}
+
+/**
+ * @brief Executes the stages of a LED pattern.
+ *
+ * @param pattern The pattern to execute.
+ * @param stop_token Ends the pattern early when set.
+ * @param hold_last_stage Return right after the last stage without waiting or
+ * turning the outputs off, the caller takes over from its delay on.
+ */
 template<size_t StageCount>
 static void execute_led_pattern(const LedPattern<StageCount>& pattern,
-                                std::atomic_bool& stop_token) noexcept {
+                                std::atomic_bool&             stop_token,
+                                const bool hold_last_stage = false) noexcept {
   if (pattern.empty()) {
     ESP_LOGE("LedPattern", "Pattern is empty");
     return;
@@ -178,8 +254,14 @@ static void execute_led_pattern(const LedPattern<StageCount>& pattern,
 
   controller::gpio::all_off();
 
-  for (const auto& [stage, delayMs] : pattern) {
-    stage();
+  led_pattern::Frame shown = led_pattern::off;
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    const auto& [frame, delayMs] = pattern[i];
+    show_frame(frame, shown);
+
+    if (hold_last_stage && i + 1 == pattern.size()) {
+      return;
+    }
 
     if (util::wait_stop_token(delayMs, stop_token)) {
       controller::gpio::all_off();
@@ -190,30 +272,90 @@ static void execute_led_pattern(const LedPattern<StageCount>& pattern,
   controller::gpio::all_off();
 }
 
+/**
+ * @brief Ends a game that was played, with the end pattern, the report and the
+ * leaderboard and history entries.
+ *
+ * @param stop_token Ends the end pattern early when set.
+ */
+static void end_game(std::atomic_bool& stop_token) noexcept {
+  // Log the execution of the end pattern
+  ESP_LOGE("TEST", "EXECUTING END PATTERN");
+  // Execute the end LED pattern right away, the statistics wait for it
+  const int64_t end_gap_us =
+  esp_timer_get_time() - app::game::get_last_end_us();
+  execute_led_pattern(led_pattern::get_end(app::game::get_last_final_score()),
+                      stop_token);
+
+  app::game::report();
+  ESP_LOGI("Controller",
+           "End pattern started %lld us after the end of the game",
+           static_cast<long long>(end_gap_us));
+
+  leaderboard::add_last_game();
+  leaderboard::log();
+  history::add_last_game();
+}
+
+/**
+ * @brief Plays the prepared or resumed game, as a load run if the load
+ * generator is enabled, and ends it.
+ *
+ * @param stop_token Ends the end pattern early when set.
+ */
+static void play_game(std::atomic_bool& stop_token) noexcept {
+  // Let the simulated players take over the buttons for a load run
+  if constexpr (config::loadgen::enabled) {
+    loadgen::start();
+  }
+
+  app::game::play();
+
+  // Judged before the end pattern, which takes seconds
+  if constexpr (config::loadgen::enabled) {
+    static_cast<void>(loadgen::finish());
+  }
+
+  end_game(stop_token);
+}
+
 }    // namespace impl
 
 /**
  * @brief Main control loop for the application.
  *
- * This function initializes the GPIO, random number generator, and I2C devices.
+ * This function initializes the GPIO, button input, random number generator,
+ * and I2C devices.
  * It then enters an infinite loop where it executes LED patterns and waits for
  * user input to start the game. The function never returns.
  */
 [[noreturn]] void take_control_no_return() noexcept {
   // Initialize GPIO pins
   impl::init_gpio();
+  // Attach the button ISRs once, the game only switches input phases
+  input::init();
   // Initialize random number generator
   impl::init_random();
+  // Rebuild the leaderboard from the scores in flash
+  leaderboard::init();
+  // Find the end of the game history in flash
+  history::init();
   // Initialize I2C devices
   impl::init_i2c_devices();
 
   // Atomic flag to control the stopping of LED patterns
   std::atomic_bool stop_token = false;
 
-  // Log the execution of the check pattern
-  ESP_LOGE("TEST", "EXECUTING CHECK PATTERN");
-  // Execute the check LED pattern
-  impl::execute_led_pattern(led_pattern::check, stop_token);
+  if (app::game::resume()) {
+    // A game cut short by a crash, a watchdog or a brownout goes on right
+    // away, without the check pattern and the attract mode
+    impl::play_game(stop_token);
+  } else {
+    // Log the execution of the check pattern
+    ESP_LOGE("TEST", "EXECUTING CHECK PATTERN");
+    // Execute the check LED pattern
+    impl::execute_led_pattern(led_pattern::check, stop_token);
+  }
 
   // Main control loop
   while (true) {
@@ -244,16 +386,20 @@ static void execute_led_pattern(const LedPattern<StageCount>& pattern,
 
     // Log the execution of the start pattern
     ESP_LOGE("TEST", "EXECUTING START PATTERN");
-    // Execute the start LED pattern
-    impl::execute_led_pattern(led_pattern::start, stop_token);
+    // Execute the start LED pattern, it returns once its last beat is shown
+    // and the game holds that beat until the go
+    impl::execute_led_pattern(led_pattern::start, stop_token, true);
+
+    // Set the game up during the last beat, its first targets light when the
+    // beat ends, counted from when it was actually shown. The player buttons
+    // are armed for the beat only, so the game loop drains every false start.
+    const int64_t go_us =
+    esp_timer_get_time() +
+    int64_t {led_pattern::start.back().delay_ms} * 1000;
+    app::game::prepare(go_us);
 
     // Start the game
-    app::game::play();
-
-    // Log the execution of the end pattern
-    ESP_LOGE("TEST", "EXECUTING END PATTERN");
-    // Execute the end LED pattern
-    impl::execute_led_pattern(led_pattern::end, stop_token);
+    impl::play_game(stop_token);
   }
 }
 
@@ -316,6 +462,35 @@ void turn_off(const uint8_t pin, Output output) noexcept {
   }
 }
 
+/**
+ * @brief Writes all 16 pins of the expander behind the given output at once.
+ *
+ * A single I2C transaction, compared to the read-modify-write pair of every
+ * `turn_on`/`turn_off` call.
+ *
+ * @param value The pin states, bit n drives pin n.
+ * @param output The expander to write (Players, SegPlayer1, SegPlayer2, SegTimer).
+ */
+void write_port(uint16_t value, Output output) noexcept {
+  switch (output) {
+    case Output::Players:
+      impl::get_mcp_players().writeGPIOAB(value);
+      break;
+    case Output::SegPlayer1:
+      impl::get_mcp_seg_player1().writeGPIOAB(value);
+      break;
+    case Output::SegPlayer2:
+      impl::get_mcp_seg_player2().writeGPIOAB(value);
+      break;
+    case Output::SegTimer:
+      impl::get_mcp_seg_timer().writeGPIOAB(value);
+      break;
+    case Output::Gpio:
+      ESP_LOGE("Gpio", "Port writes are only supported on the expanders");
+      break;
+  }
+}
+
 /**
  * @brief Turns on the specified row of LEDs for the given player.
  *
@@ -421,22 +596,11 @@ void turn_off_row(Player player, Row row) noexcept {
 }
 
 void all_off() noexcept {
-  for (const uint8_t& pin : config::mcp::player1_out) {
-    turn_off(pin, Output::Players);
-  }
-  for (const uint8_t& pin : config::mcp::player2_out) {
-    turn_off(pin, Output::Players);
-  }
-  for (const uint8_t& pin : config::mcp::seg_left_pins) {
-    turn_off(pin, Output::SegPlayer1);
-    turn_off(pin, Output::SegPlayer2);
-    turn_off(pin, Output::SegTimer);
-  }
-  for (const uint8_t& pin : config::mcp::seg_right_pins) {
-    turn_off(pin, Output::SegPlayer1);
-    turn_off(pin, Output::SegPlayer2);
-    turn_off(pin, Output::SegTimer);
-  }
+  // One write per expander, the decimal points go off as well
+  write_port(0, Output::Players);
+  write_port(0, Output::SegPlayer1);
+  write_port(0, Output::SegPlayer2);
+  write_port(0, Output::SegTimer);
   turn_off(config::gpio::start_out, Output::Gpio);
 }
 
@@ -444,7 +608,8 @@ void all_off() noexcept {
  * @brief Displays a two-digit number on a 7-segment display.
  *
  * This function takes a number between 0 and 99 and displays it on a specified
- * 7-segment display. If the number is greater than 99, it will display 99.
+ * 7-segment display. If the number is greater than 99, it will display 99. Both
+ * digits are written at once, the decimal point is turned off.
  *
  * @param number The number to display (0-99).
  * @param display The 7-segment display to use (Player1, Player2, Timer).
@@ -454,44 +619,36 @@ void display_segment_number(uint8_t number, SegmentDisplay display) noexcept {
     ESP_LOGE("LedPattern", "Number out of range, displaying max number");
     number = 99;
   }
-//
-  const uint8_t tens = number / 10;
-  const uint8_t ones = number % 10;
-
-  for (size_t i = 0; i < 7; ++i) {
-    switch (display) {
-      case SegmentDisplay::Player1:
-        impl::get_segment_for_digit(tens).at(i)
-        ? turn_on(config::mcp::seg_left_pins.at(i), Output::SegPlayer1)
-        : turn_off(config::mcp::seg_left_pins.at(i), Output::SegPlayer1);
-
-        impl::get_segment_for_digit(ones).at(i)
-        ? turn_on(config::mcp::seg_right_pins.at(i), Output::SegPlayer1)
-        : turn_off(config::mcp::seg_right_pins.at(i), Output::SegPlayer1);
-
-        break;
-      case SegmentDisplay::Player2:
-        impl::get_segment_for_digit(tens).at(i)
-        ? turn_on(config::mcp::seg_left_pins.at(i), Output::SegPlayer2)
-        : turn_off(config::mcp::seg_left_pins.at(i), Output::SegPlayer2);
-
-        impl::get_segment_for_digit(ones).at(i)
-        ? turn_on(config::mcp::seg_right_pins.at(i), Output::SegPlayer2)
-        : turn_off(config::mcp::seg_right_pins.at(i), Output::SegPlayer2);
-
-        break;
-      case SegmentDisplay::Timer:
-        impl::get_segment_for_digit(tens).at(i)
-        ? turn_on(config::mcp::seg_left_pins.at(i), Output::SegTimer)
-        : turn_off(config::mcp::seg_left_pins.at(i), Output::SegTimer);
-
-        impl::get_segment_for_digit(ones).at(i)
-        ? turn_on(config::mcp::seg_right_pins.at(i), Output::SegTimer)
-        : turn_off(config::mcp::seg_right_pins.at(i), Output::SegTimer);
-
-        break;
-    }
+
+  const auto tens = static_cast<uint8_t>(number / 10);
+  const auto ones = static_cast<uint8_t>(number % 10);
+
+  write_port(led_pattern::get_segment_port(tens, ones, false),
+             impl::get_segment_output(display));
+}
+
+/**
+ * @brief Displays a time given in tenths of a second on a 7-segment display.
+ *
+ * Whole seconds from 10 seconds on, below that the seconds and the tenths
+ * separated by the decimal point, `9.9` to `0.0`.
+ *
+ * @param tenths The time in tenths of a second.
+ * @param display The 7-segment display to use (Player1, Player2, Timer).
+ */
+void display_segment_tenths(const uint16_t tenths,
+                            SegmentDisplay display) noexcept {
+  if (tenths >= 100) {
+    display_segment_number(static_cast<uint8_t>(std::min(tenths / 10, 99)),
+                           display);
+    return;
   }
+
+  const auto seconds = static_cast<uint8_t>(tenths / 10);
+  const auto rest    = static_cast<uint8_t>(tenths % 10);
+
+  write_port(led_pattern::get_segment_port(seconds, rest, true),
+             impl::get_segment_output(display));
 }
 
 /**
@@ -502,32 +659,8 @@ void display_segment_number(uint8_t number, SegmentDisplay display) noexcept {
  * @param display The 7-segment display to turn off (Player1, Player2, Timer).
  */
 void turn_off_segment(SegmentDisplay display) noexcept {
-  for (const uint8_t& pin : config::mcp::seg_left_pins) {
-    switch (display) {
-      case SegmentDisplay::Player1:
-        turn_off(pin, Output::SegPlayer1);
-        break;
-      case SegmentDisplay::Player2:
-        turn_off(pin, Output::SegPlayer2);
-        break;
-      case SegmentDisplay::Timer:
-        turn_off(pin, Output::SegTimer);
-        break;
-    }
-  }
-  for (const uint8_t& pin : config::mcp::seg_right_pins) {
-    switch (display) {
-      case SegmentDisplay::Player1:
-        turn_off(pin, Output::SegPlayer1);
-        break;
-      case SegmentDisplay::Player2:
-        turn_off(pin, Output::SegPlayer2);
-        break;
-      case SegmentDisplay::Timer:
-        turn_off(pin, Output::SegTimer);
-        break;
-    }
-  }
+  // Both digits and the decimal points in one write
+  write_port(0, impl::get_segment_output(display));
 }
 
 }    // namespace gpio
@@ -544,18 +677,16 @@ namespace util {
  * @return A pair of input and output pins for the specified player.
  */
 [[nodiscard]] gpio::PlayerPins get_random_player_pins(Player player) noexcept {
+  const config::stations::Station& station =
+  config::stations::stations.at(static_cast<size_t>(player));
+
   // Generate a random index within the range of available pins
-  const uint8_t random_index =
-  static_cast<const uint8_t>(random(config::gpio::player1_in.size()));
+  const auto random_index = static_cast<uint8_t>(
+  get_random().below(config::stations::targets_per_station));
 
   // Return the corresponding input and output pins for the specified player
-  if (player == Player::Player1) {
-    return {config::gpio::player1_in.at(random_index),
-            config::mcp::player1_out.at(random_index)};
-  } else {
-    return {config::gpio::player2_in.at(random_index),
-            config::mcp::player2_out.at(random_index)};
-  }
+  return {station.buttons_in.at(random_index),
+          station.leds_out.at(random_index)};
 }
 
 /**
@@ -1,161 +1,665 @@
 #include "app_game.hpp"
 
+#include "app_buttons.hpp"
 #include "app_controller.hpp"
+#include "app_game_core.hpp"
+#include "app_game_record.hpp"
+#include "app_histogram.hpp"
+#include "app_input.hpp"
+#include "app_random.hpp"
+#include "app_running_stats.hpp"
+#include "app_snapshot.hpp"
 #include "config.hpp"
 #include "global.hpp"
-#include <driver/gpio.h>
-#include <esp_attr.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/portmacro.h>
 #include <freertos/projdefs.h>
-#include <freertos/queue.h>
-#include <hal/gpio_types.h>
 
+#include <Arduino.h>
+#include <algorithm>
 #include <array>
 #include <atomic>
-#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <limits>
-#include <thread>
+#include <span>
+#include <utility>
 
 namespace app::game {
 namespace impl {
 
-using QueueStorage = std::array<uint8_t,
-                                config::game::input_queue_item_size *
-                                config::game::input_queue_size>;
+/**
+ * @brief Retrieves the final score of the game.
+ *
+ * This function returns a reference to a static `FinalScore` object that holds
+ * the final scores of all players. The initial scores are set to the maximum
+ * score defined in the configuration.
+ *
+ * @return A reference to the `FinalScore` object containing the final scores.
+ */
+[[nodiscard]] static FinalScore& get_final_score() noexcept {
+  // Static variable to hold the final scores, initialized to max scores
+  static FinalScore s_final_score = []() noexcept {
+    FinalScore scores = {};
+    scores.fill(config::game::max_score);
+    return scores;
+  }();
+  return s_final_score;
+}
+
+using TargetLitTimes = std::array<int64_t, core::target_count>;
+
+// Measurements of one player over one game
+struct PlayerMeters {
+  LatencyHistogram service;        // correct press until the next target is lit
+  LatencyHistogram reaction;       // target lit until the correct press
+  RunningStats     reaction_stats;
+  TargetLitTimes   lit_us;         // when each target was lit last
+  uint16_t         lit_targets;    // one bit per target lit at the last write
+};
+
+using Meters = std::array<PlayerMeters, core::player_count>;
+
+// Presses of each player before the go
+using FalseStarts = std::array<uint8_t, core::player_count>;
+
+// Everything of the current or the last game. Prepared during the countdown,
+// kept off the stack of the game loop and read by the report after the end
+// pattern.
+struct Session {
+  core::GameState  state;
+  core::Actions    actions;
+  core::GameRecord record;
+  Meters           meters;
+  FalseStarts      false_starts;
+  int64_t          go_us;       // when the first targets are due to light
+  int64_t          lit_us;      // when the first targets were lit
+  int64_t          ended_us;    // when the game loop saw the end
+  bool             resumed;     // went on from a snapshot after a reset
+  size_t           dropped;     // actions lost because a frame was full
+};
+
+[[nodiscard]] static Session& get_session() noexcept {
+  static Session s_session = {};
+  return s_session;
+}
 
-[[nodiscard]] static QueueHandle_t& get_gpio_queue() noexcept {
-  static StaticQueue_t s_static_queue_handle = {};
-  static QueueStorage  s_queue_storage       = {};
+// Time from the due time of a target expiry until the moved target is lit
+[[nodiscard]] static LatencyHistogram& get_last_expiry_jitter() noexcept {
+  static LatencyHistogram s_last_expiry_jitter = {};
+  return s_last_expiry_jitter;
+}
+
+// Every correct press of the current or the last game
+[[nodiscard]] static history::Game& get_last_history() noexcept {
+  static history::Game s_last_history = {};
+  return s_last_history;
+}
 
-  static QueueHandle_t s_queue_handle =
-  xQueueCreateStatic(config::game::input_queue_size,
-                     config::game::input_queue_item_size,
-                     s_queue_storage.data(),
-                     &s_static_queue_handle);
+// Reaction times to every target of every player over all games since boot
+using TargetReactions =
+std::array<std::array<LatencyHistogram, core::target_count>,
+           core::player_count>;
 
-  return s_queue_handle;
+[[nodiscard]] static TargetReactions& get_target_reactions() noexcept {
+  static TargetReactions s_target_reactions = {};
+  return s_target_reactions;
 }
 
 /**
- * @brief ISR handler for button GPIO interrupts.
- *
- * This function is called when a button GPIO interrupt occurs. It sends the GPIO number
- * to the queue and yields from the ISR if a higher priority task was woken.
- *
- * @param gpio_arg Pointer to the GPIO number that triggered the interrupt.
+ * @brief Returns the target draws of the Adaptive target mode, built from the
+ * target reactions between games.
  */
-static void IRAM_ATTR isr_buttons_gpio(void* gpio_arg) noexcept {
-  // Convert the GPIO argument to a uint8_t GPIO number
-  const auto gpio_num =
-  static_cast<uint8_t>(reinterpret_cast<ptrdiff_t>(gpio_arg));
-
-  BaseType_t higher_priority_task_woken = pdFALSE;
-  // Send the GPIO number to the queue from the ISR
-  xQueueSendFromISR(get_gpio_queue(), &gpio_num, &higher_priority_task_woken);
-
-  // Yield from the ISR if a higher priority task was woken
-  if (higher_priority_task_woken == pdTRUE) {
-    portYIELD_FROM_ISR();
+[[nodiscard]] static core::TargetTables& get_target_tables() noexcept {
+  static core::TargetTables s_target_tables = []() noexcept {
+    core::TargetTables tables = {};
+    core::build_target_tables({}, tables);
+    return tables;
+  }();
+  return s_target_tables;
+}
+
+[[nodiscard]] static core::TargetTimes get_target_times() noexcept {
+  core::TargetTimes times_us = {};
+
+  for (size_t player = 0; player < core::player_count; ++player) {
+    for (size_t target = 0; target < core::target_count; ++target) {
+      times_us[player][target] =
+      get_target_reactions()[player][target].percentile_us(50);
+    }
   }
+
+  return times_us;
 }
+
 /**
- * @brief Retrieves the final score of the game.
+ * @brief Rebuilds the target draws from the median reaction time to every
+ * target.
+ */
+static void rebuild_target_tables() noexcept {
+  if constexpr (config::game::target_mode ==
+                config::game::TargetMode::Adaptive) {
+    core::build_target_tables(get_target_times(), get_target_tables());
+  }
+}
+
+static void log_target_times() noexcept {
+  // A space and up to 7 digits per target, the largest median in ms
+  constexpr size_t entry_chars = 8;
+
+  const core::TargetTimes times_us = get_target_times();
+
+  for (size_t player = 0; player < core::player_count; ++player) {
+    std::array<char, core::target_count * entry_chars + 1> line = {};
+
+    size_t length = 0;
+    for (const uint32_t time_us : times_us[player]) {
+      const int written =
+      std::snprintf(line.data() + length,
+                    line.size() - length,
+                    " %lu",
+                    static_cast<unsigned long>(time_us / 1000));
+      if (written < 0 || length + static_cast<size_t>(written) >= line.size()) {
+        break;
+      }
+      length += static_cast<size_t>(written);
+    }
+
+    ESP_LOGI("Game",
+             "Player %u: target p50 ms%s",
+             static_cast<unsigned int>(player + 1),
+             line.data());
+  }
+}
+
+[[nodiscard]] static LatencyHistogram& get_last_service_latency() noexcept {
+  static LatencyHistogram s_last_service_latency = {};
+  return s_last_service_latency;
+}
+
+[[nodiscard]] static std::array<ReactionStats, core::player_count>&
+get_last_reaction_stats() noexcept {
+  static std::array<ReactionStats, core::player_count> s_last_reaction_stats =
+  {};
+  return s_last_reaction_stats;
+}
+
+static void log_expiry_jitter() noexcept {
+  const LatencyHistogram& jitter = get_last_expiry_jitter();
+
+  ESP_LOGI("Game",
+           "Expiries: %lu, due to lit avg %lu us p50 %lu us p99 %lu us max "
+           "%lu us",
+           static_cast<unsigned long>(jitter.count()),
+           static_cast<unsigned long>(jitter.mean_us()),
+           static_cast<unsigned long>(jitter.percentile_us(50)),
+           static_cast<unsigned long>(jitter.percentile_us(99)),
+           static_cast<unsigned long>(jitter.max_us()));
+}
+
+/**
+ * @brief Records the reaction time of a hit, the time from lighting the target
+ * to the press. Presses that beat the target are not counted.
+ */
+static void record_reaction(const core::Action& hit,
+                            PlayerMeters&       meters) noexcept {
+  const int64_t reaction_us = hit.time_us - meters.lit_us.at(hit.value);
+  if (reaction_us < 0) {
+    return;
+  }
+
+  meters.reaction.record(reaction_us);
+  get_target_reactions()[hit.player][hit.value].record(reaction_us);
+  meters.reaction_stats.record(static_cast<uint32_t>(
+  std::min<int64_t>(reaction_us, std::numeric_limits<uint32_t>::max())));
+}
+
+/**
+ * @brief Adds a hit to the history of the game, with the reaction time
+ * measured like `record_reaction`.
+ */
+static void record_hit(const core::GameState& state,
+                       const core::Action&    hit,
+                       const PlayerMeters&    meters) noexcept {
+  const int64_t reaction_us =
+  std::max<int64_t>(hit.time_us - meters.lit_us.at(hit.value), 0);
+
+  get_last_history().add(
+  {static_cast<uint32_t>((hit.time_us - state.start_us) / 1000),
+   static_cast<uint32_t>(reaction_us / 1000),
+   hit.player,
+   static_cast<uint8_t>(hit.value)});
+}
+
+/**
+ * @brief Notes when the targets of a player that a port write turned on were
+ * lit, targets that stay lit keep their time.
+ */
+static void record_lit(const size_t   player,
+                       const uint16_t port,
+                       const int64_t  lit_us,
+                       PlayerMeters&  meters) noexcept {
+  const config::stations::Station& station =
+  config::stations::stations[player];
+
+  uint32_t lit_targets = 0;
+  for (size_t target = 0; target < core::target_count; ++target) {
+    if ((port & 1U << station.leds_out[target]) == 0) {
+      continue;
+    }
+    if ((meters.lit_targets & 1U << target) == 0) {
+      meters.lit_us[target] = lit_us;
+    }
+    lit_targets |= 1U << target;
+  }
+  meters.lit_targets = static_cast<uint16_t>(lit_targets);
+}
+
+[[nodiscard]] static ReactionStats
+summarize_reactions(const PlayerMeters& meters) noexcept {
+  const RunningStats& stats = meters.reaction_stats;
+  return {stats.count(),
+          stats.min(),
+          static_cast<uint32_t>(stats.mean()),
+          static_cast<uint32_t>(stats.stddev()),
+          meters.reaction.percentile_us(50),
+          meters.reaction.percentile_us(95)};
+}
+
+static void log_player(const size_t        player,
+                       const PlayerMeters& meters) noexcept {
+  const LatencyHistogram& service  = meters.service;
+  const ReactionStats     reaction = summarize_reactions(meters);
+
+  ESP_LOGI("Game",
+           "Player %u: %lu hits, press to next target avg %lu us p50 %lu us "
+           "p95 %lu us p99 %lu us max %lu us",
+           static_cast<unsigned int>(player + 1),
+           static_cast<unsigned long>(service.count()),
+           static_cast<unsigned long>(service.mean_us()),
+           static_cast<unsigned long>(service.percentile_us(50)),
+           static_cast<unsigned long>(service.percentile_us(95)),
+           static_cast<unsigned long>(service.percentile_us(99)),
+           static_cast<unsigned long>(service.max_us()));
+  ESP_LOGI("Game",
+           "Player %u: reaction min %lu ms mean %lu ms stddev %lu ms p50 %lu "
+           "ms p95 %lu ms",
+           static_cast<unsigned int>(player + 1),
+           static_cast<unsigned long>(reaction.min_us / 1000),
+           static_cast<unsigned long>(reaction.mean_us / 1000),
+           static_cast<unsigned long>(reaction.stddev_us / 1000),
+           static_cast<unsigned long>(reaction.p50_us / 1000),
+           static_cast<unsigned long>(reaction.p95_us / 1000));
+}
+
+using PublishedTargets = std::array<std::atomic_uint8_t, core::player_count>;
+
+/**
+ * @brief Returns the target indices of the running game.
  *
- * This function returns a reference to a static `FinalScore` object that holds
- * the final scores for both players. The initial scores are set to the maximum
- * score defined in the configuration.
+ * Written by the game loop after the targets are lit, read by the simulated
+ * players of the load generator. `no_target` while no game is running.
+ */
+[[nodiscard]] static PublishedTargets& get_published_targets() noexcept {
+  static PublishedTargets s_published_targets =
+  []<size_t... Players>(std::index_sequence<Players...>) noexcept {
+    return PublishedTargets {(static_cast<void>(Players), no_target)...};
+  }(std::make_index_sequence<core::player_count>());
+  return s_published_targets;
+}
+
+/**
+ * @brief Publishes the targets for the load generator, compiled out without.
+ */
+static void publish_targets(const core::GameState& state) noexcept {
+  if constexpr (config::loadgen::enabled) {
+    for (size_t player = 0; player < core::player_count; ++player) {
+      get_published_targets()[player].store(state.target_indices[player],
+                                            std::memory_order_release);
+    }
+  }
+}
+
+static void unpublish_targets() noexcept {
+  for (std::atomic_uint8_t& target : get_published_targets()) {
+    target.store(no_target, std::memory_order_release);
+  }
+}
+
+static void on_deadline_timer(void* /*arg*/) noexcept {
+  input::wake();
+}
+
+/**
+ * @brief Returns the one-shot timer that wakes the game loop at the earliest
+ * pending deadline.
+ */
+[[nodiscard]] static esp_timer_handle_t get_deadline_timer() noexcept {
+  static esp_timer_handle_t s_timer = []() noexcept {
+    const esp_timer_create_args_t args = {
+      .callback              = on_deadline_timer,
+      .arg                   = nullptr,
+      .dispatch_method       = ESP_TIMER_TASK,
+      .name                  = "game_deadline",
+      .skip_unhandled_events = false,
+    };
+
+    esp_timer_handle_t timer = nullptr;
+    esp_timer_create(&args, &timer);
+    return timer;
+  }();
+
+  return s_timer;
+}
+
+static void stop_deadline_timer() noexcept {
+  // Fails harmlessly if the timer is not running
+  esp_timer_stop(get_deadline_timer());
+}
+
+/**
+ * @brief Arms the deadline timer to fire at the given time.
  *
- * @return A reference to the `FinalScore` object containing the final scores.
+ * @param due_us The time to fire at, deadlines in the past fire immediately.
  */
-[[nodiscard]] static FinalScore& get_final_score() noexcept {
-  // Static variable to hold the final scores, initialized to max scores
-  static FinalScore s_final_score = {config::game::max_score,
-                                     config::game::max_score};
-  return s_final_score;
+static void arm_deadline_timer(const int64_t due_us) noexcept {
+  stop_deadline_timer();
+
+  const int64_t delay_us = std::max<int64_t>(due_us - esp_timer_get_time(), 0);
+  esp_timer_start_once(get_deadline_timer(), static_cast<uint64_t>(delay_us));
 }
 
 /**
- * @brief Generates a random player pin different from the current one.
+ * @brief Returns true if a later action updates the same display.
+ */
+[[nodiscard]] static bool is_superseded(const core::Actions& actions,
+                                        const size_t         index) noexcept {
+  const core::Action& action = actions.items.at(index);
+
+  for (size_t i = index + 1; i < actions.size; ++i) {
+    const core::Action& later = actions.items.at(i);
+    if (later.kind == action.kind && later.player == action.player) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Lights the targets moved by the actions from `first` on with a single
+ * port write and measures the hits among them.
  *
- * This function generates a random pin index for a player that is different
- * from the provided current pin index. It ensures that the new pin index
- * is not the same as the current one.
+ * Runs right after every press, so a hit is visible before the remaining
+ * presses of the batch, the displays and the timer are handled. The last
+ * `ShowTargets` holds the LED state after all steps.
  *
- * @param current The current pin index that should not be selected.
- * @return A new random pin index different from the current one.
+ * @param actions The actions collected so far.
+ * @param first The first action whose targets are not shown yet.
+ * @param state The current state, holds the targets that are lit.
+ * @param meters The measurements of the players.
+ * @return The number of actions whose targets are shown.
  */
-[[nodiscard]] static uint8_t generate_random_player_pin(
-uint8_t current) noexcept {
-  uint8_t pin = current;
+[[nodiscard]] static size_t
+show_targets(const core::Actions&   actions,
+             const size_t           first,
+             const core::GameState& state,
+             Meters&                meters) noexcept {
+  const core::Action* targets = nullptr;
+  for (size_t i = first; i < actions.size; ++i) {
+    if (actions.items[i].kind == core::ActionKind::ShowTargets) {
+      targets = &actions.items[i];
+    }
+  }
 
-  // Generate a new random pin index until it is different from the current one
-  while (pin == current) {
-    pin = random() % config::gpio::player1_in.size();
+  if (targets == nullptr) {
+    return actions.size;
   }
 
-  return pin;
+  controller::gpio::write_port(targets->value, Output::Players);
+
+  const int64_t lit_us = esp_timer_get_time();
+
+  // Players whose next `ShowTargets` follows a hit
+  std::array<bool, core::player_count> hit = {};
+
+  for (size_t i = first; i < actions.size; ++i) {
+    const core::Action& action = actions.items[i];
+
+    if (action.kind == core::ActionKind::Expired) {
+      get_last_expiry_jitter().record(lit_us - action.time_us);
+      continue;
+    }
+    if (action.kind == core::ActionKind::Hit) {
+      PlayerMeters& player_meters = meters.at(action.player);
+      record_reaction(action, player_meters);
+      record_hit(state, action, player_meters);
+
+      // The hit target went dark, lighting it again starts a new reaction
+      player_meters.lit_targets = static_cast<uint16_t>(
+      player_meters.lit_targets & ~(1U << action.value));
+      hit.at(action.player) = true;
+      continue;
+    }
+    if (action.kind != core::ActionKind::ShowTargets) {
+      continue;
+    }
+
+    // The first targets of the game are lit for all players at once
+    if (action.player >= core::player_count) {
+      for (size_t player = 0; player < core::player_count; ++player) {
+        record_lit(player, action.value, lit_us, meters[player]);
+      }
+      continue;
+    }
+
+    PlayerMeters& player_meters = meters.at(action.player);
+    if (hit.at(action.player)) {
+      hit.at(action.player) = false;
+      player_meters.service.record(lit_us - action.time_us);
+    }
+    record_lit(action.player, action.value, lit_us, player_meters);
+  }
+
+  return actions.size;
 }
 
 /**
- * @brief Attaches the ISR handler for the start button GPIO interrupt.
+ * @brief Commits the actions collected for one batch of events as one frame.
+ *
+ * Targets not shown yet go first as a single port write. The displays follow
+ * in the order the actions were produced, which is the capture order of the
+ * presses, skipping values that a later action overwrites anyway.
  *
- * This function adds the ISR handler for the start button GPIO interrupt.
- * It associates the `isr_buttons_gpio` function with the GPIO number
- * specified in the configuration for the start button.
+ * @param actions The actions of the batch.
+ * @param shown The number of actions whose targets are already shown.
+ * @param state The state after the batch, holds the targets that are lit.
+ * @param meters The measurements of the players.
+ */
+static void commit(const core::Actions&   actions,
+                   const size_t           shown,
+                   const core::GameState& state,
+                   Meters&                meters) noexcept {
+  static_cast<void>(show_targets(actions, shown, state, meters));
+
+  for (size_t i = 0; i < actions.size; ++i) {
+    const core::Action& action = actions.items.at(i);
+
+    switch (action.kind) {
+      case core::ActionKind::ShowScore:
+        if (!is_superseded(actions, i)) {
+          controller::gpio::display_segment_number(
+          static_cast<uint8_t>(action.value),
+          static_cast<SegmentDisplay>(
+          config::stations::stations.at(action.player).score_display));
+        }
+        break;
+      case core::ActionKind::ShowTime:
+        if (!is_superseded(actions, i)) {
+          controller::gpio::display_segment_tenths(action.value,
+                                                   SegmentDisplay::Timer);
+        }
+        break;
+      case core::ActionKind::ArmTimer:
+        if (!is_superseded(actions, i)) {
+          arm_deadline_timer(action.time_us);
+        }
+        break;
+      case core::ActionKind::ShowTargets:
+      case core::ActionKind::Hit:
+      case core::ActionKind::Expired:
+      case core::ActionKind::End:
+        break;
+    }
+  }
+}
+
+/**
+ * @brief Counts the presses of the player buttons captured before the go.
  */
-static void attach_isr_start() noexcept {
-  gpio_isr_handler_add(static_cast<gpio_num_t>(config::gpio::start_in),
-                       isr_buttons_gpio,
-                       reinterpret_cast<void*>(config::gpio::start_in));
+static void
+count_false_starts(Session&                            session,
+                   const std::span<const input::Event> events) noexcept {
+  for (const input::Event& event : events) {
+    const buttons::Button button = buttons::classify(event.gpio_num);
+    if (event.timestamp_us >= session.go_us ||
+        button.kind != buttons::Kind::Player) {
+      continue;
+    }
+
+    uint8_t& count = session.false_starts.at(button.player);
+    if (count < std::numeric_limits<uint8_t>::max()) {
+      ++count;
+    }
+  }
 }
 
 /**
- * @brief Detaches the ISR handler for the start button GPIO interrupt.
+ * @brief Waits for the go, presses until then are false starts.
  *
- * This function removes the ISR handler associated with the start button GPIO
- * interrupt, effectively disabling the interrupt for the start button.
+ * Blocks on the input queue for the whole ticks left and spins through the
+ * rest, so the first frame is committed within microseconds of the go.
  */
-static void detach_isr_start() noexcept {
-  gpio_isr_handler_remove(static_cast<gpio_num_t>(config::gpio::start_in));
+static void wait_for_go(Session&                      session,
+                        const std::span<input::Event> batch) noexcept {
+  while (true) {
+    const int64_t remaining_us = session.go_us - esp_timer_get_time();
+    if (remaining_us <= 0) {
+      return;
+    }
+
+    const auto remaining_ms = static_cast<uint32_t>(remaining_us / 1000);
+    if (remaining_ms < portTICK_PERIOD_MS) {
+      continue;
+    }
+
+    const size_t count =
+    input::receive_batch(batch, remaining_ms / portTICK_PERIOD_MS);
+    count_false_starts(session, batch.first(count));
+  }
 }
 
 /**
- * @brief Attaches the ISR handlers for the player buttons GPIO interrupts.
+ * @brief Logs the record of a game, the log in hex lines of 32 bytes.
  *
- * This function adds the ISR handlers for the player buttons GPIO interrupts.
- * It associates the `isr_buttons_gpio` function with the GPIO numbers
- * specified in the configuration for both player 1 and player 2 buttons.
+ * Together with the target times logged before it, the lines are all a host
+ * needs to replay the game with `core::replay`.
  */
-static void attach_isr_players() noexcept {
-  for (const uint8_t& pin : config::gpio::player1_in) {
-    gpio_isr_handler_add(static_cast<gpio_num_t>(pin),
-                         isr_buttons_gpio,
-                         reinterpret_cast<void*>(pin));
+static void log_record(const core::GameRecord& record) noexcept {
+  constexpr size_t line_bytes = 32;
+  constexpr char   digits[]   = "0123456789abcdef";
+
+  const Random::State&           seed = record.get_seed();
+  const std::span<const uint8_t> log  = record.get_log();
+  ESP_LOGI("Game",
+           "Record seed %08lx %08lx %08lx %08lx start %lld us, %u bytes%s",
+           static_cast<unsigned long>(seed[0]),
+           static_cast<unsigned long>(seed[1]),
+           static_cast<unsigned long>(seed[2]),
+           static_cast<unsigned long>(seed[3]),
+           static_cast<long long>(record.get_start_us()),
+           static_cast<unsigned int>(log.size()),
+           record.is_truncated() ? ", truncated" : "");
+
+  for (size_t offset = 0; offset < log.size(); offset += line_bytes) {
+    const std::span<const uint8_t> line =
+    log.subspan(offset, std::min(line_bytes, log.size() - offset));
+
+    std::array<char, line_bytes * 2 + 1> hex = {};
+    for (size_t i = 0; i < line.size(); ++i) {
+      hex[2 * i]     = digits[line[i] >> 4U];
+      hex[2 * i + 1] = digits[line[i] & 0x0FU];
+    }
+    ESP_LOGI("Game",
+             "Record %04x %s",
+             static_cast<unsigned int>(offset),
+             hex.data());
   }
+}
 
-  for (const uint8_t& pin : config::gpio::player2_in) {
-    gpio_isr_handler_add(static_cast<gpio_num_t>(pin),
-                         isr_buttons_gpio,
-                         reinterpret_cast<void*>(pin));
+/**
+ * @brief Replays the record of the last game through the core and logs
+ * whether it reproduced the game.
+ */
+static void check_record(const Session& session) noexcept {
+  // Kept off the stack like the session
+  static core::GameState    s_state   = {};
+  static core::TargetTables s_tables  = {};
+  static core::Actions      s_actions = {};
+
+  size_t     frames   = 0;
+  const bool complete = core::replay(session.record,
+                                     s_state,
+                                     s_tables,
+                                     s_actions,
+                                     [&frames](const core::Actions&) noexcept {
+                                       ++frames;
+                                     });
+
+  if (!complete || s_state.scores != session.state.scores ||
+      s_state.target_leds != session.state.target_leds) {
+    ESP_LOGW("Game", "Replay of the record does not match the game");
+    return;
   }
+  ESP_LOGI("Game",
+           "Replay of %u frames matches the game",
+           static_cast<unsigned int>(frames));
 }
 
 /**
- * @brief Detaches the ISR handlers for the player buttons GPIO interrupts.
+ * @brief Resets the session for a game that goes on at `go_us`.
  *
- * This function removes the ISR handlers associated with the player buttons GPIO
- * interrupts, effectively disabling the interrupts for both player 1 and player 2 buttons.
+ * Piecewise, a whole temporary session would not fit the stack.
  */
-static void detach_isr_players() noexcept {
-  for (const uint8_t& pin : config::gpio::player1_in) {
-    gpio_isr_handler_remove(static_cast<gpio_num_t>(pin));
+static void reset_session(Session& session, const int64_t go_us) noexcept {
+  for (PlayerMeters& meters : session.meters) {
+    meters = {};
   }
+  session.actions.clear();
+  session.false_starts = {};
+  session.go_us        = go_us;
+  session.lit_us       = go_us;
+  session.ended_us     = go_us;
+  session.resumed      = false;
+
+  get_last_expiry_jitter().clear();
+  get_last_history().clear();
+}
 
-  for (const uint8_t& pin : config::gpio::player2_in) {
-    gpio_isr_handler_remove(static_cast<gpio_num_t>(pin));
+/**
+ * @brief Keeps the running game in RTC memory, so it survives a reset.
+ *
+ * @param now_us The time of the frame that was just committed.
+ */
+static void save_snapshot(const core::GameState& state,
+                          const int64_t          now_us) noexcept {
+  if constexpr (config::game::resume_enabled) {
+    if (!state.over) {
+      snapshot::save(core::take_snapshot(state, now_us));
+    }
   }
 }
 
@@ -164,155 +668,302 @@ static void detach_isr_players() noexcept {
 /**
  * @brief Waits for the start button press.
  *
- * This function waits for the start button to be pressed by attaching the ISR handler
- * for the start button GPIO interrupt. It continuously checks the GPIO queue until
- * the start button GPIO number is received, indicating the button press. Once the
- * button is pressed, it detaches the ISR handler.
+ * This function waits for the start button to be pressed by switching the input
+ * to the start phase. It continuously checks the input queue until the start
+ * button GPIO number is received, indicating the button press. Once the button
+ * is pressed, the input is disabled again.
  */
 void wait_for_start_press() noexcept {
-  impl::attach_isr_start();
+  input::set_phase(input::Phase::Start);
 
-  uint8_t gpio_num = std::numeric_limits<uint8_t>::max();
-  while (gpio_num != config::gpio::start_in) {
-    xQueueReceive(impl::get_gpio_queue(), &gpio_num, portMAX_DELAY);
+  input::Event event = {0, std::numeric_limits<uint8_t>::max()};
+  while (event.gpio_num != config::gpio::start_in) {
+    static_cast<void>(input::receive(event, portMAX_DELAY));
   }
 
-  impl::detach_isr_start();
+  input::set_phase(input::Phase::Disabled);
 }
 
 /**
- * @brief Executes the main game loop.
+ * @brief Sets up the next game during the last beat of the countdown.
  *
- * This function runs the main game loop, handling the game logic for both players.
- * It initializes the ISR handlers for the player buttons, sets up the game timer,
- * and manages the game state until one of the players reaches the maximum score
- * or the timer runs out. The function also updates the display with the current
- * scores and the remaining time.
+ * The targets, the clock and the first frame are computed for a game that
+ * starts at `go_us` and the player buttons are armed, so `play` only has to
+ * wait for the go and commit the first frame. Presses before the go are
+ * false starts, `play` drains them from the input queue while it waits.
+ *
+ * @param go_us When the countdown ends and the first targets light.
  */
-void play() noexcept {
+void prepare(const int64_t go_us) noexcept {
   ESP_LOGE("TEST", "GAME_BEGIN");
 
-  // Attach ISR handlers for player buttons
-  impl::attach_isr_players();
-
-  // Generate initial random target pins for both players
-  uint8_t player1_target_index =
-  impl::generate_random_player_pin(std::numeric_limits<uint8_t>::max());
-  uint8_t player2_target_index =
-  impl::generate_random_player_pin(std::numeric_limits<uint8_t>::max());
-
-  // Initialize player scores
-  uint8_t player1_score = 0;
-  uint8_t player2_score = 0;
-
-  // Initialize game timer and stop token
-  std::atomic_int8_t timer            = config::game::game_time;
-  std::atomic_bool   timer_stop_token = false;
-
-  // Start the game timer thread
-  std::thread timer_thread([&timer, &timer_stop_token]() {
-    controller::gpio::display_segment_number(static_cast<uint8_t>(timer),
-                                             SegmentDisplay::Timer);
-    while (timer > 0) {
-      if (controller::util::wait_stop_token(1000, timer_stop_token)) {
-        break;
-      }
+  impl::Session& session = impl::get_session();
+  impl::reset_session(session, go_us);
+
+  ESP_LOGI("Game", "Mode %s", core::get_mode_name());
+
+  // The game continues the shared generator, its state at this point, the
+  // target times and the events the loop steps with replay the whole game
+  session.record.begin(get_random().get_state(),
+                       go_us,
+                       config::game::target_mode ==
+                       config::game::TargetMode::Adaptive
+                       ? impl::get_target_times()
+                       : core::TargetTimes {});
+
+  core::start(session.state,
+              go_us,
+              get_random(),
+              impl::get_target_tables(),
+              session.actions);
+
+  // Forward presses of the player buttons
+  input::reset_batch_stats();
+  input::set_phase(input::Phase::Players);
+}
 
-      --timer;
-      controller::gpio::display_segment_number(static_cast<uint8_t>(timer),
-                                               SegmentDisplay::Timer);
-    }
-  });
+/**
+ * @brief Sets up the game an unexpected reset cut short, if there is one.
+ *
+ * The game goes on right away with the scores, target sequences, generator
+ * and time left of its last frame, its targets are lit anew. `play` runs it
+ * like a prepared game whose go is now. Its record starts at the resume and
+ * cannot be replayed.
+ *
+ * @return False if there is no game to resume, see `snapshot::restore`.
+ */
+[[nodiscard]] bool resume() noexcept {
+  core::Snapshot snapshot = {};
+  if (!snapshot::restore(snapshot)) {
+    return false;
+  }
+
+  const int64_t  now_us  = esp_timer_get_time();
+  impl::Session& session = impl::get_session();
+  impl::reset_session(session, now_us);
+  session.resumed = true;
+
+  ESP_LOGI("Game", "Mode %s, resumed", core::get_mode_name());
 
-  // Display initial scores
-  controller::gpio::display_segment_number(player1_score,
-                                           SegmentDisplay::Player1);
-  controller::gpio::display_segment_number(player2_score,
-                                           SegmentDisplay::Player2);
+  session.record.begin(snapshot.random, now_us, core::TargetTimes {});
+  core::resume(session.state,
+               snapshot,
+               now_us,
+               impl::get_target_tables(),
+               session.actions);
 
-  // Turn on initial target pins for both players
-  controller::gpio::turn_on(config::mcp::player1_out.at(player1_target_index),
-                            Output::Players);
-  controller::gpio::turn_on(config::mcp::player2_out.at(player2_target_index),
-                            Output::Players);
+  // Forward presses of the player buttons
+  input::reset_batch_stats();
+  input::set_phase(input::Phase::Players);
+  return true;
+}
+
+/**
+ * @brief Executes the main game loop of the prepared game.
+ *
+ * The rules live in `core`, this loop only translates. It commits the first
+ * frame on the go, then blocks until a batch of presses or a deadline wake up
+ * arrives, steps the core through the presses in capture order and up to the
+ * current time, and commits the resulting actions to the LEDs, the displays
+ * and the deadline timer as one frame. The game ends when the core reports it
+ * over, by time or by maximum score. Only the results are stored on the way
+ * out, `report` logs them later.
+ */
+void play() noexcept {
+  impl::Session&   session = impl::get_session();
+  core::GameState& state   = session.state;
+  core::Actions&   actions = session.actions;
+  impl::Meters&    meters  = session.meters;
+
+  // Presses drained from the queue in one loop round
+  std::array<input::Event, config::game::input_queue_size> batch = {};
+
+  impl::wait_for_go(session, batch);
+  impl::commit(actions, 0, state, meters);
+  session.record.commit(actions);
+  session.dropped = actions.dropped;
+  impl::publish_targets(state);
+  impl::save_snapshot(state, session.go_us);
+  session.lit_us = meters.front().lit_us[state.target_indices.front()];
 
   // Main game loop
-  while (player1_score < config::game::max_score &&
-         player2_score < config::game::max_score && timer > 0) {
-    uint8_t gpio_num = std::numeric_limits<uint8_t>::max();
-    xQueueReceive(impl::get_gpio_queue(),
-                  &gpio_num,
-                  config::game::game_wait_for_input / portTICK_PERIOD_MS);
-
-    if (timer == 0) {
-      break;
+  while (!state.over) {
+    const size_t count = input::receive_batch(batch, portMAX_DELAY);
+    actions.clear();
+
+    // Arbitrate by capture time instead of queue order or player number
+    const std::span<input::Event> events = std::span(batch).first(count);
+    std::ranges::sort(events, {}, &input::Event::timestamp_us);
+
+    // Presses captured before the go may only arrive now, the core drops them
+    impl::count_false_starts(session, events);
+
+    // Bring the clock up to each press first, so a press captured before a
+    // target expired still hits it and presses captured after the end of the
+    // game are dropped, then handle what became due until now
+    size_t shown = 0;
+    for (const input::Event& event : events) {
+      const core::Event press = {core::EventKind::Press,
+                                 event.gpio_num,
+                                 event.timestamp_us};
+
+      session.record.add(press);
+      core::step(state, {core::EventKind::Time, 0, press.time_us}, actions);
+      core::step(state, press, actions);
+
+      // Fast path, a hit lights its staged next target before anything else
+      shown = impl::show_targets(actions, shown, state, meters);
     }
 
-    // Check if player 1 pressed the correct button
-    if (gpio_num == config::gpio::player1_in.at(player1_target_index)) {
-      controller::gpio::turn_off(
-      config::mcp::player1_out.at(player1_target_index),
-      Output::Players);
+    const core::Event now = {core::EventKind::Time, 0, esp_timer_get_time()};
+    session.record.add(now);
+    core::step(state, now, actions);
 
-      ++player1_score;
+    impl::commit(actions, shown, state, meters);
+    session.record.commit(actions);
+    session.dropped += actions.dropped;
+    impl::publish_targets(state);
+    impl::save_snapshot(state, now.time_us);
+  }
 
-      if (timer == 0) {
-        break;
-      }
+  session.ended_us = esp_timer_get_time();
+  snapshot::clear();
+  impl::get_last_history().duration_ms =
+  static_cast<uint32_t>((session.ended_us - session.go_us) / 1000);
 
-      controller::gpio::display_segment_number(player1_score,
-                                               SegmentDisplay::Player1);
-      player1_target_index =
-      impl::generate_random_player_pin(player1_target_index);
+  // Stop forwarding presses of the player buttons
+  input::set_phase(input::Phase::Disabled);
 
-      if (timer == 0) {
-        break;
-      }
+  impl::unpublish_targets();
+  impl::stop_deadline_timer();
+  get_random() = state.random;
 
-      controller::gpio::turn_on(
-      config::mcp::player1_out.at(player1_target_index),
-      Output::Players);
-    }
-    // Check if player 2 pressed the correct button
-    else if (gpio_num == config::gpio::player2_in.at(player2_target_index)) {
-      controller::gpio::turn_off(
-      config::mcp::player2_out.at(player2_target_index),
-      Output::Players);
+  LatencyHistogram& last_latency = impl::get_last_service_latency();
+  last_latency.clear();
+  for (size_t player = 0; player < core::player_count; ++player) {
+    last_latency.merge(meters[player].service);
+    impl::get_last_reaction_stats()[player] =
+    impl::summarize_reactions(meters[player]);
+  }
+  impl::rebuild_target_tables();
 
-      ++player2_score;
+  // Store the final scores
+  impl::get_final_score() = state.scores;
+}
 
-      if (timer == 0) {
-        break;
-      }
+/**
+ * @brief Logs the statistics of the last game, kept out of `play` so the end
+ * pattern does not wait for the log output.
+ */
+void report() noexcept {
+  const impl::Session& session = impl::get_session();
+
+  ESP_LOGI("Game",
+           "First targets lit %lld us after the go",
+           static_cast<long long>(session.lit_us - session.go_us));
+
+  for (size_t player = 0; player < core::player_count; ++player) {
+    impl::log_player(player, session.meters[player]);
+    ESP_LOGI("Game",
+             "Player %u: %u false starts",
+             static_cast<unsigned int>(player + 1),
+             static_cast<unsigned int>(session.false_starts[player]));
+  }
+  impl::log_target_times();
+  if (session.resumed) {
+    // The clock restarts at a reset, so this is the time the resume took
+    ESP_LOGI("Game",
+             "Resumed game lit its targets %lld us after boot",
+             static_cast<long long>(session.lit_us));
+  } else {
+    impl::log_record(session.record);
+    if constexpr (config::game::replay_check) {
+      impl::check_record(session);
+    }
+  }
 
-      controller::gpio::display_segment_number(player2_score,
-                                               SegmentDisplay::Player2);
-      player2_target_index =
-      impl::generate_random_player_pin(player2_target_index);
+  const LatencyHistogram& last_latency = impl::get_last_service_latency();
+  if (last_latency.percentile_us(99) > config::game::feedback_budget_us) {
+    ESP_LOGW("Game",
+             "Press to feedback p99 %lu us is over the budget of %lu us",
+             static_cast<unsigned long>(last_latency.percentile_us(99)),
+             static_cast<unsigned long>(config::game::feedback_budget_us));
+  }
+  if (session.dropped > 0) {
+    ESP_LOGW("Game",
+             "%u actions were dropped from full frames",
+             static_cast<unsigned int>(session.dropped));
+  }
+  if constexpr (config::game::expiry_enabled) {
+    impl::log_expiry_jitter();
+  }
+  input::log_stats();
+}
 
-      if (timer == 0) {
-        break;
-      }
+[[nodiscard]] FinalScore get_last_final_score() noexcept {
+  return impl::get_final_score();
+}
 
-      controller::gpio::turn_on(
-      config::mcp::player2_out.at(player2_target_index),
-      Output::Players);
-    }
+/**
+ * @brief Returns the current target index of each player, `no_target` if no
+ * game is running. Only updated while the load generator is enabled.
+ */
+[[nodiscard]] Targets get_current_targets() noexcept {
+  Targets targets = {};
+  for (size_t player = 0; player < core::player_count; ++player) {
+    targets[player] =
+    impl::get_published_targets()[player].load(std::memory_order_acquire);
   }
+  return targets;
+}
 
-  // Detach ISR handlers for player buttons
-  impl::detach_isr_players();
+/**
+ * @brief Returns the press to next target latencies of all players of the
+ * last game.
+ */
+[[nodiscard]] LatencyHistogram get_last_service_latency() noexcept {
+  return impl::get_last_service_latency();
+}
 
-  // Stop the timer thread
-  timer_stop_token = true;
-  timer_thread.join();
+/**
+ * @brief Returns the time from the due time of every target expiry of the last
+ * game until the moved target was lit.
+ */
+[[nodiscard]] LatencyHistogram get_last_expiry_jitter() noexcept {
+  return impl::get_last_expiry_jitter();
+}
 
-  // Store the final scores
-  impl::get_final_score() = {player1_score, player2_score};
+/**
+ * @brief Returns the correct presses of the last game, valid until the next
+ * game is prepared.
+ */
+[[nodiscard]] const history::Game& get_last_history() noexcept {
+  return impl::get_last_history();
 }
 
-[[nodiscard]] FinalScore get_last_final_score() noexcept {
-  return impl::get_final_score();
+/**
+ * @brief Returns when the first targets of the last game were lit.
+ */
+[[nodiscard]] int64_t get_last_lit_us() noexcept {
+  return impl::get_session().lit_us;
+}
+
+/**
+ * @brief Returns when the last game loop saw the end of its game.
+ */
+[[nodiscard]] int64_t get_last_end_us() noexcept {
+  return impl::get_session().ended_us;
+}
+
+/**
+ * @brief Returns the reaction times of a player in the last game, from
+ * lighting a target to pressing it.
+ *
+ * @param player The station index of the player.
+ */
+[[nodiscard]] ReactionStats
+get_last_reaction_stats(const size_t player) noexcept {
+  return impl::get_last_reaction_stats().at(player);
 }
 
 }    // namespace app::game
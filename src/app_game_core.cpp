@@ -0,0 +1,828 @@
+#include "app_game_core.hpp"
+
+#include "app_buttons.hpp"
+#include "app_game_mode.hpp"
+#include "config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace app::game::core {
+namespace impl {
+
+using config::stations::stations;
+
+[[nodiscard]] constexpr static bool fits_led_port() noexcept {
+  for (const config::stations::Station& station : stations) {
+    for (const uint8_t pin : station.leds_out) {
+      if (pin >= 16) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// All target LEDs are lit with one write of the 16 bit player LED port
+static_assert(fits_led_port());
+
+[[nodiscard]] static uint16_t get_led(const size_t  player,
+                                      const uint8_t target) noexcept {
+  return static_cast<uint16_t>(1U << stations[player].leds_out[target]);
+}
+
+/**
+ * @brief Returns the LEDs of all targets of a player on the player LED port.
+ */
+[[nodiscard]] constexpr static uint16_t
+get_station_leds(const size_t player) noexcept {
+  uint32_t leds = 0;
+  for (const uint8_t pin : stations.at(player).leds_out) {
+    leds |= 1U << pin;
+  }
+  return static_cast<uint16_t>(leds);
+}
+
+static_assert(config::game::lit_targets >= 1 &&
+              config::game::lit_targets <= target_count);
+
+/**
+ * @brief Generates a random target index different from the current one.
+ *
+ * @param random The random generator of the game.
+ * @param current The current target index that should not be selected.
+ * @return A new random target index different from the current one.
+ */
+[[nodiscard]] static uint8_t generate_target(Random&       random,
+                                             const uint8_t current) noexcept {
+  return static_cast<uint8_t>(random.below_except(target_count, current));
+}
+
+/**
+ * @brief Fills a sequence with shuffled bags of all targets.
+ *
+ * Every target shows up once per bag, so over a game each player travels to
+ * every button equally often. A bag that would start with the last target of
+ * the previous one swaps its first entry away to avoid an immediate repeat.
+ */
+static void fill_bags(Random& random, TargetSequence& sequence) noexcept {
+  std::array<uint8_t, target_count> bag = {};
+  for (size_t i = 0; i < bag.size(); ++i) {
+    bag.at(i) = static_cast<uint8_t>(i);
+  }
+
+  uint8_t previous = std::numeric_limits<uint8_t>::max();
+  for (size_t begin = 0; begin < TargetSequence::length; begin += bag.size()) {
+    // Fisher-Yates shuffle
+    for (size_t i = bag.size() - 1; i > 0; --i) {
+      std::swap(bag.at(i), bag.at(random.below(static_cast<uint32_t>(i + 1))));
+    }
+
+    if (bag.front() == previous) {
+      const size_t other = 1 + random.below(target_count - 1);
+      std::swap(bag.front(), bag.at(other));
+    }
+
+    const size_t count = std::min(bag.size(), TargetSequence::length - begin);
+    for (size_t i = 0; i < count; ++i) {
+      sequence.set(begin + i, bag.at(i));
+    }
+    previous = bag.back();
+  }
+}
+
+/**
+ * @brief Pre-generates the target sequences of all players for the configured
+ * target mode, does nothing in Live mode.
+ */
+static void fill_sequences(GameState& state) noexcept {
+  using config::game::TargetMode;
+
+  // Swaps the left and the right column, the row stays the same
+  constexpr uint8_t mirror = target_count / 2;
+
+  switch (config::game::target_mode) {
+    case TargetMode::Live:
+    case TargetMode::Adaptive:
+      break;
+    case TargetMode::Bag:
+      for (TargetSequence& sequence : state.sequences) {
+        fill_bags(state.random, sequence);
+      }
+      break;
+    case TargetMode::Identical:
+    case TargetMode::Mirrored:
+      fill_bags(state.random, state.sequences.front());
+      for (size_t player = 1; player < player_count; ++player) {
+        for (size_t i = 0; i < TargetSequence::length; ++i) {
+          uint8_t target = state.sequences.front().at(i);
+          if (config::game::target_mode == TargetMode::Mirrored) {
+            target ^= mirror;
+          }
+          state.sequences.at(player).set(i, target);
+        }
+      }
+      break;
+  }
+}
+
+/**
+ * @brief Returns true if the targets are rolled after every hit instead of
+ * being pre-generated.
+ */
+[[nodiscard]] constexpr static bool is_rolled() noexcept {
+  using config::game::TargetMode;
+
+  return config::game::target_mode == TargetMode::Live ||
+         config::game::target_mode == TargetMode::Adaptive;
+}
+
+/**
+ * @brief Returns the weight of a target for the Adaptive target mode.
+ *
+ * 256 for a target as fast as the average of the player, scaled by the
+ * configured bias for slower or faster ones and kept within 1/8 and 8 times
+ * that, so no target ever vanishes from the game.
+ */
+[[nodiscard]] static uint32_t get_weight(const uint32_t time_us,
+                                         const uint32_t average_us) noexcept {
+  constexpr int64_t unit = 256;
+
+  if (time_us == 0 || average_us == 0) {
+    return unit;
+  }
+
+  const int64_t deviation = int64_t {time_us} - int64_t {average_us};
+  const int64_t weight =
+  unit + unit * config::game::adaptive_bias * deviation /
+         (int64_t {100} * int64_t {average_us});
+
+  return static_cast<uint32_t>(std::clamp(weight, unit / 8, unit * 8));
+}
+
+/**
+ * @brief Returns the target the next hit of a player moves to, takes the next
+ * entry of a pre-generated sequence.
+ */
+[[nodiscard]] static uint8_t next_target(GameState&    state,
+                                         const uint8_t player) noexcept {
+  using config::game::TargetMode;
+
+  const uint8_t current = state.target_indices.at(player);
+
+  if constexpr (config::game::target_mode == TargetMode::Live) {
+    return generate_target(state.random, current);
+  } else if constexpr (config::game::target_mode == TargetMode::Adaptive) {
+    return state.tables->at(player).at(current).sample(state.random);
+  } else {
+    // Penalties can make a player need more hits than the sequence holds,
+    // the targets after its end are rolled
+    uint8_t& cursor = state.cursors.at(player);
+    if (cursor >= TargetSequence::length) {
+      return generate_target(state.random, current);
+    }
+    return state.sequences.at(player).at(cursor++);
+  }
+}
+
+/**
+ * @brief Arms the firmware timer if the earliest deadline or expiry changed.
+ */
+static void rearm(GameState& state, Actions& actions) noexcept {
+  const int64_t due_us = std::min(state.deadlines.empty()
+                                  ? Expiries::never
+                                  : state.deadlines.top().due_us,
+                                  state.expiries.next_due_us());
+
+  if (due_us == Expiries::never || due_us == state.armed_us) {
+    return;
+  }
+
+  // A timer that is not armed is armed again by the next step
+  if (actions.push({ActionKind::ArmTimer, 0, 0, due_us})) {
+    state.armed_us = due_us;
+  }
+}
+
+/**
+ * @brief Returns the time a player has to hit a target at the given score.
+ */
+[[nodiscard]] static int64_t get_expiry_us(const uint8_t score) noexcept {
+  const uint32_t shrink_ms = std::min(config::game::expiry_step_ms * score,
+                                      config::game::expiry_start_ms);
+
+  return int64_t {std::max(config::game::expiry_start_ms - shrink_ms,
+                           config::game::expiry_min_ms)} *
+         1000;
+}
+
+/**
+ * @brief Replaces the expiry of the target of a player, does nothing unless
+ * targets expire.
+ *
+ * @param from_us When the target was lit.
+ */
+static void arm_expiry(GameState&    state,
+                       const uint8_t player,
+                       const int64_t from_us) noexcept {
+  if constexpr (config::game::expiry_enabled) {
+    Expiries::Handle& handle = state.expiry_handles.at(player);
+
+    state.expiries.cancel(handle);
+    handle = state.expiries.schedule(
+    from_us + get_expiry_us(state.scores.at(player)), player);
+  }
+}
+
+/**
+ * @brief Lights a set of targets and decoys for a player, the LED port value
+ * is updated for that player only.
+ */
+static void light(GameState&     state,
+                  const uint8_t  player,
+                  const uint16_t targets,
+                  const uint16_t decoys) noexcept {
+  state.target_masks[player] = targets;
+  state.decoy_masks[player]  = decoys;
+  state.target_leds          = static_cast<uint16_t>(
+  (state.target_leds & ~get_station_leds(player)) | targets | decoys);
+}
+
+/**
+ * @brief Picks distinct random targets of a player with a partial
+ * Fisher-Yates shuffle.
+ *
+ * @param count How many targets to pick.
+ * @param taken The LEDs of targets that must not be picked.
+ * @return The LEDs of the picked targets.
+ */
+[[nodiscard]] static uint16_t pick_leds(Random&        random,
+                                        const uint8_t  player,
+                                        const size_t   count,
+                                        const uint16_t taken) noexcept {
+  std::array<uint8_t, target_count> pool = {};
+  size_t                            size = 0;
+  for (uint8_t target = 0; target < target_count; ++target) {
+    if ((get_led(player, target) & taken) == 0) {
+      pool[size++] = target;
+    }
+  }
+
+  uint16_t leds = 0;
+  for (size_t i = 0; i < count && i < size; ++i) {
+    const size_t other =
+    i + random.below(static_cast<uint32_t>(size - i));
+    std::swap(pool[i], pool[other]);
+    leds |= get_led(player, pool[i]);
+  }
+
+  return leds;
+}
+
+/**
+ * @brief Returns the masks that light a target together with the other
+ * targets or decoys of the light mode.
+ */
+[[nodiscard]] static StagedTarget make_staged(GameState&    state,
+                                              const uint8_t player,
+                                              const uint8_t target) noexcept {
+  using config::game::LightMode;
+
+  constexpr size_t others = config::game::lit_targets - 1U;
+
+  const uint16_t led = get_led(player, target);
+  switch (config::game::light_mode) {
+    case LightMode::Single:
+      break;
+    case LightMode::All:
+      return {target,
+              static_cast<uint16_t>(
+              led | pick_leds(state.random, player, others, led)),
+              0};
+    case LightMode::Decoy:
+      return {target, led, pick_leds(state.random, player, others, led)};
+  }
+
+  return {target, led, 0};
+}
+
+/**
+ * @brief Lights staged masks and stages what the following hit lights.
+ */
+static void show_staged(GameState&         state,
+                        const uint8_t      player,
+                        const StagedTarget staged) noexcept {
+  state.target_indices[player] = staged.target;
+  light(state, player, staged.targets, staged.decoys);
+
+  state.staged[player] = make_staged(state, player, next_target(state, player));
+}
+
+/**
+ * @brief Makes a target the current one of a player, outside of a hit.
+ */
+static void show_target(GameState&    state,
+                        const uint8_t player,
+                        const uint8_t target) noexcept {
+  show_staged(state, player, make_staged(state, player, target));
+}
+
+/**
+ * @brief Returns a target that is still lit in a mask of the player LED port.
+ */
+[[nodiscard]] static uint8_t find_target(const uint8_t  player,
+                                         const uint16_t leds) noexcept {
+  for (uint8_t target = 0; target < target_count; ++target) {
+    if ((get_led(player, target) & leds) != 0) {
+      return target;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Moves a target that was not hit in time and takes the penalty.
+ *
+ * The new target is rolled in every target mode, a pre-generated sequence
+ * stays reserved for the hits and the entry staged for the next hit stays.
+ */
+static void expire(GameState&    state,
+                   const uint8_t player,
+                   const int64_t due_us,
+                   Actions&      actions) noexcept {
+  // The expiry fired, its handle is free again
+  state.expiry_handles.at(player) = Expiries::no_timer;
+
+  if (state.over || due_us >= state.end_us) {
+    return;
+  }
+
+  if (is_rolled()) {
+    show_target(state, player, next_target(state, player));
+  } else {
+    const StagedTarget moved =
+    make_staged(state,
+                player,
+                generate_target(state.random, state.target_indices[player]));
+    state.target_indices[player] = moved.target;
+    light(state, player, moved.targets, moved.decoys);
+  }
+
+  uint8_t& score = state.scores.at(player);
+  score          = static_cast<uint8_t>(
+  score - std::min(score, config::game::expiry_penalty));
+
+  actions.push({ActionKind::Expired, player, 0, due_us});
+  actions.push({ActionKind::ShowTargets, player, state.target_leds, due_us});
+  if (config::game::expiry_penalty > 0) {
+    actions.push({ActionKind::ShowScore, player, score, due_us});
+  }
+
+  // Measured from the due time, so a late wake up does not give extra time
+  arm_expiry(state, player, due_us);
+}
+
+/**
+ * @brief The classic game, a hit on a lit target scores and moves it on.
+ *
+ * The target, light and expiry settings of `config::game` shape it further.
+ */
+struct Classic {
+  static constexpr config::game::Mode id   = config::game::Mode::Classic;
+  static constexpr const char*         name = "Classic";
+
+  /**
+   * @brief Pre-generates the target sequences unless the targets are rolled
+   * and lights the first targets with their expiries.
+   */
+  static void on_start(GameState&    state,
+                       const int64_t now_us,
+                       Actions& /*actions*/) noexcept {
+    fill_sequences(state);
+
+    for (uint8_t player = 0; player < player_count; ++player) {
+      const uint8_t target =
+      is_rolled()
+      ? generate_target(state.random, std::numeric_limits<uint8_t>::max())
+      : next_target(state, player);
+
+      show_target(state, player, target);
+      arm_expiry(state, player, now_us);
+    }
+  }
+
+  /**
+   * @brief Lights the targets and decoys a resumed game had lit, with fresh
+   * expiries.
+   */
+  static void on_resume(GameState&    state,
+                        const int64_t now_us,
+                        Actions& /*actions*/) noexcept {
+    for (uint8_t player = 0; player < player_count; ++player) {
+      light(state,
+            player,
+            state.target_masks[player],
+            state.decoy_masks[player]);
+      arm_expiry(state, player, now_us);
+    }
+  }
+
+  /**
+   * @brief Scores a press if it hit a lit target of its player, takes the
+   * penalty if it hit a decoy.
+   *
+   * The same path serves every player, the button is classified with one
+   * table load and one AND with the lit masks of its player, and the LED port
+   * value is updated for that player only from the masks staged when the
+   * target was lit, so the cost of a press grows neither with the number of
+   * stations nor with the number of lit targets.
+   */
+  static bool on_press(GameState&             state,
+                       const buttons::Button& button,
+                       const int64_t          time_us,
+                       Actions&               actions) noexcept {
+    const uint8_t  player = button.player;
+    const uint16_t led    = get_led(player, button.target);
+    uint8_t&       score  = state.scores[player];
+
+    if ((state.target_masks[player] & led) == 0) {
+      if ((state.decoy_masks[player] & led) != 0) {
+        score = static_cast<uint8_t>(
+        score - std::min(score, config::game::decoy_penalty));
+        actions.push({ActionKind::ShowScore, player, score, time_us});
+      }
+      return false;
+    }
+
+    ++score;
+    actions.push({ActionKind::Hit, player, button.target, time_us});
+
+    // In the All light mode the set stays until its last target is hit
+    const auto remaining =
+    static_cast<uint16_t>(state.target_masks[player] & ~led);
+    if (remaining != 0) {
+      light(state, player, remaining, state.decoy_masks[player]);
+      state.target_indices[player] = find_target(player, remaining);
+    } else {
+      show_staged(state, player, state.staged[player]);
+      arm_expiry(state, player, time_us);
+    }
+
+    actions.push({ActionKind::ShowTargets, player, state.target_leds, time_us});
+    actions.push({ActionKind::ShowScore, player, score, time_us});
+    return true;
+  }
+
+  static void on_deadline(GameState&    state,
+                          const uint8_t player,
+                          const int64_t due_us,
+                          Actions&      actions) noexcept {
+    expire(state, player, due_us, actions);
+  }
+
+  static void on_end(GameState& /*state*/, Actions& /*actions*/) noexcept {}
+};
+
+/**
+ * @brief The classic game where a press on a button that is not lit costs
+ * points as well.
+ */
+struct Penalty : Classic {
+  static constexpr config::game::Mode id   = config::game::Mode::Penalty;
+  static constexpr const char*         name = "Penalty";
+
+  static bool on_press(GameState&             state,
+                       const buttons::Button& button,
+                       const int64_t          time_us,
+                       Actions&               actions) noexcept {
+    if (Classic::on_press(state, button, time_us, actions)) {
+      return true;
+    }
+
+    // Decoys already took their own penalty
+    const uint8_t player = button.player;
+    if ((state.decoy_masks[player] & get_led(player, button.target)) != 0) {
+      return false;
+    }
+
+    uint8_t& score = state.scores[player];
+    score          = static_cast<uint8_t>(
+    score - std::min(score, config::game::miss_penalty));
+    actions.push({ActionKind::ShowScore, player, score, time_us});
+    return false;
+  }
+};
+
+using Modes      = ModeRegistry<Classic, Penalty>;
+using ActiveMode = Modes::Select<config::game::mode>;
+
+static_assert(GameMode<ActiveMode>);
+
+static void finish(GameState& state, Actions& actions) noexcept {
+  ActiveMode::on_end(state, actions);
+
+  state.over = true;
+  state.deadlines.clear();
+  state.expiries.reset(state.end_us);
+  actions.push({ActionKind::End, 0, 0, 0});
+}
+
+/**
+ * @brief Returns the time until the next clock tick.
+ *
+ * Whole seconds while the display shows seconds, tenths in the final seconds.
+ * Every tick is scheduled from the previous deadline, never from the time it
+ * was handled, so late ticks do not make the clock drift.
+ */
+[[nodiscard]] static int64_t
+get_tick_interval_us(const int64_t remaining_us) noexcept {
+  return remaining_us > int64_t {config::game::tenths_below_s} * second_us
+         ? second_us
+         : tenth_us;
+}
+
+/**
+ * @brief Handles all expiries and deadlines that are due at the given time.
+ */
+static void advance(GameState&    state,
+                    const int64_t now_us,
+                    Actions&      actions) noexcept {
+  if constexpr (config::game::expiry_enabled) {
+    state.expiries.advance(
+    now_us,
+    [&state, &actions](const uint8_t player, const int64_t due_us) noexcept {
+      ActiveMode::on_deadline(state, player, due_us, actions);
+    });
+  }
+
+  while (!state.over && !state.deadlines.empty() &&
+         state.deadlines.top().due_us <= now_us) {
+    const Deadline<DeadlineKind> deadline = state.deadlines.pop();
+
+    switch (deadline.kind) {
+      case DeadlineKind::ClockTick: {
+        const int64_t remaining_us = state.end_us - deadline.due_us;
+        actions.push({ActionKind::ShowTime,
+                      0,
+                      static_cast<uint16_t>(remaining_us / tenth_us),
+                      deadline.due_us});
+
+        if (remaining_us > 0) {
+          static_cast<void>(state.deadlines.push(
+          deadline.due_us + get_tick_interval_us(remaining_us),
+          DeadlineKind::ClockTick));
+        }
+        break;
+      }
+      case DeadlineKind::GameEnd:
+        // The last clock tick is due at the same time but may not be popped
+        actions.push({ActionKind::ShowTime, 0, 0, deadline.due_us});
+        finish(state, actions);
+        break;
+    }
+  }
+
+  rearm(state, actions);
+}
+
+/**
+ * @brief Hands a press inside the game time on a player button to the mode
+ * and ends the game when it reached the maximum score.
+ */
+static void press(GameState&    state,
+                  const uint8_t gpio_num,
+                  const int64_t time_us,
+                  Actions&      actions) noexcept {
+  // Presses captured before the start or after the end of the game do not
+  // count
+  if (state.over || time_us < state.start_us || time_us >= state.end_us) {
+    return;
+  }
+
+  const buttons::Button button = buttons::classify(gpio_num);
+  if (button.kind != buttons::Kind::Player) {
+    return;
+  }
+
+  if (!ActiveMode::on_press(state, button, time_us, actions)) {
+    return;
+  }
+
+  if (state.scores[button.player] >= config::game::max_score) {
+    finish(state, actions);
+  }
+  rearm(state, actions);
+}
+
+/**
+ * @brief Resets the state for a game that runs from `now_us` to `end_us`.
+ */
+static void reset(GameState&          state,
+                  const int64_t       now_us,
+                  const int64_t       end_us,
+                  const Random        random,
+                  const TargetTables& tables) noexcept {
+  state          = {};
+  state.random   = random;
+  state.tables   = &tables;
+  state.start_us = now_us;
+  state.end_us   = end_us;
+  state.expiries.reset(now_us);
+  state.expiry_handles.fill(Expiries::no_timer);
+}
+
+/**
+ * @brief Schedules the clock ticks and the end of the game and shows the
+ * initial outputs, the targets are lit already.
+ *
+ * The ticks fall on whole seconds or tenths of the remaining time, also when
+ * a resumed game starts in between.
+ */
+static void schedule(GameState&    state,
+                     const int64_t now_us,
+                     Actions&      actions) noexcept {
+  static_cast<void>(
+  state.deadlines.push(state.end_us, DeadlineKind::GameEnd));
+
+  const int64_t remaining_us = state.end_us - now_us;
+  const int64_t tick_us      = get_tick_interval_us(remaining_us);
+  const int64_t offset_us    = remaining_us % tick_us;
+  static_cast<void>(state.deadlines.push(
+  now_us + (offset_us > 0 ? offset_us : tick_us), DeadlineKind::ClockTick));
+
+  actions.push({ActionKind::ShowTime,
+                0,
+                static_cast<uint16_t>(std::max(remaining_us, int64_t {0}) /
+                                      tenth_us),
+                now_us});
+  for (uint8_t player = 0; player < player_count; ++player) {
+    actions.push({ActionKind::ShowScore, player, state.scores[player], now_us});
+  }
+  actions.push({ActionKind::ShowTargets,
+                std::numeric_limits<uint8_t>::max(),
+                state.target_leds,
+                now_us});
+
+  rearm(state, actions);
+}
+
+}    // namespace impl
+
+/**
+ * @brief Starts a new game.
+ *
+ * Resets the state, lets the game mode pick the first targets and schedules
+ * the clock ticks and the end of the game.
+ *
+ * @param state The state to (re)initialize.
+ * @param now_us The start time of the game.
+ * @param random The generator to pick targets with, copied into the state so
+ * the game can be replayed from it.
+ * @param tables The target draws of the Adaptive target mode, must outlive the
+ * game.
+ * @param actions Receives the actions showing the initial outputs.
+ */
+void start(GameState&          state,
+           const int64_t       now_us,
+           const Random        random,
+           const TargetTables& tables,
+           Actions&            actions) noexcept {
+  impl::reset(state,
+              now_us,
+              now_us + int64_t {config::game::game_time} * second_us,
+              random,
+              tables);
+
+  impl::ActiveMode::on_start(state, now_us, actions);
+  impl::schedule(state, now_us, actions);
+}
+
+/**
+ * @brief Returns what a running game needs to go on after a reset.
+ *
+ * @param state The state of the running game.
+ * @param now_us The time of the last committed frame.
+ */
+[[nodiscard]] Snapshot take_snapshot(const GameState& state,
+                                     const int64_t    now_us) noexcept {
+  return {state.scores,
+          state.target_indices,
+          state.target_masks,
+          state.decoy_masks,
+          state.staged,
+          state.sequences,
+          state.cursors,
+          state.random.get_state(),
+          state.end_us - now_us};
+}
+
+/**
+ * @brief Goes on with a game from a snapshot.
+ *
+ * Like `start`, but the game has the scores, targets, target sequences and
+ * generator of the snapshot and only the time it had left. The game mode
+ * lights the targets of the snapshot again.
+ *
+ * @param state The state to (re)initialize.
+ * @param snapshot The snapshot of the game, see `take_snapshot`.
+ * @param now_us When the game goes on.
+ * @param tables The target draws of the Adaptive target mode, must outlive the
+ * game.
+ * @param actions Receives the actions showing the outputs of the snapshot.
+ */
+void resume(GameState&          state,
+            const Snapshot&     snapshot,
+            const int64_t       now_us,
+            const TargetTables& tables,
+            Actions&            actions) noexcept {
+  impl::reset(state,
+              now_us,
+              now_us + snapshot.remaining_us,
+              Random {snapshot.random},
+              tables);
+  state.scores         = snapshot.scores;
+  state.target_indices = snapshot.target_indices;
+  state.target_masks   = snapshot.target_masks;
+  state.decoy_masks    = snapshot.decoy_masks;
+  state.staged         = snapshot.staged;
+  state.sequences      = snapshot.sequences;
+  state.cursors        = snapshot.cursors;
+
+  impl::ActiveMode::on_resume(state, now_us, actions);
+  impl::schedule(state, now_us, actions);
+}
+
+/**
+ * @brief Advances the game by one event.
+ *
+ * @param state The state of the running game.
+ * @param event A press or the current time.
+ * @param actions Receives the output changes caused by the event.
+ */
+void step(GameState& state, const Event& event, Actions& actions) noexcept {
+  switch (event.kind) {
+    case EventKind::Press:
+      impl::press(state, event.gpio_num, event.time_us, actions);
+      break;
+    case EventKind::Time:
+      impl::advance(state, event.time_us, actions);
+      break;
+  }
+}
+
+/**
+ * @brief Returns the player LED port value that lights exactly the current
+ * targets of all players.
+ */
+[[nodiscard]] uint16_t get_target_leds(const GameState& state) noexcept {
+  return state.target_leds;
+}
+
+/**
+ * @brief Returns the name of the game mode the core was built with.
+ */
+[[nodiscard]] const char* get_mode_name() noexcept {
+  return impl::ActiveMode::name;
+}
+
+/**
+ * @brief Builds the target draws of the Adaptive target mode.
+ *
+ * Runs between games, drawing a target during the game is then constant time
+ * whatever the weights are.
+ *
+ * @param times_us The typical reaction time to each target of each player.
+ * @param tables Receives one table per player and current target.
+ */
+void build_target_tables(const TargetTimes& times_us,
+                         TargetTables&      tables) noexcept {
+  for (size_t player = 0; player < player_count; ++player) {
+    const std::array<uint32_t, target_count>& times = times_us.at(player);
+
+    uint64_t total_us = 0;
+    uint32_t known    = 0;
+    for (const uint32_t time_us : times) {
+      total_us += time_us;
+      known    += time_us > 0 ? 1 : 0;
+    }
+    const auto average_us =
+    static_cast<uint32_t>(known > 0 ? total_us / known : 0);
+
+    AliasTable<target_count>::Weights weights = {};
+    for (size_t target = 0; target < target_count; ++target) {
+      weights.at(target) = impl::get_weight(times.at(target), average_us);
+    }
+
+    for (size_t current = 0; current < target_count; ++current) {
+      AliasTable<target_count>::Weights others = weights;
+      others.at(current)                       = 0;
+      tables.at(player).at(current).build(others);
+    }
+  }
+}
+
+}    // namespace app::game::core
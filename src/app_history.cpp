@@ -0,0 +1,125 @@
+#include "app_history.hpp"
+
+#include "app_game.hpp"
+#include "app_history_codec.hpp"
+#include "app_partition_storage.hpp"
+#include "app_record_ring.hpp"
+#include "config.hpp"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace app::history {
+namespace impl {
+
+using GameRing = RecordRing<PartitionStorage>;
+
+static_assert(max_encoded <= GameRing::max_size,
+              "An encoded game must fit into a sector");
+
+[[nodiscard]] static PartitionStorage& get_storage() noexcept {
+  static PartitionStorage s_storage = {};
+  return s_storage;
+}
+
+[[nodiscard]] static GameRing& get_ring() noexcept {
+  static GameRing s_ring {get_storage()};
+  return s_ring;
+}
+
+// Set once the ring is loaded, games are not stored before
+[[nodiscard]] static bool& get_ready() noexcept {
+  static bool s_ready = false;
+  return s_ready;
+}
+
+}    // namespace impl
+
+/**
+ * @brief Finds the end of the stored games, streams them to the log if
+ * configured.
+ */
+void init() noexcept {
+  impl::get_ready() = impl::get_storage().open(config::history::partition) &&
+                      impl::get_ring().load();
+  if (!impl::get_ready()) {
+    ESP_LOGE("History",
+             "Partition %s is missing or unreadable, games are not kept",
+             config::history::partition);
+    return;
+  }
+
+  if constexpr (config::history::export_at_boot) {
+    export_games();
+  }
+}
+
+/**
+ * @brief Encodes the history of the last game and appends it to the ring.
+ *
+ * Logs the size of the encoded game and the time the encoding took.
+ */
+void add_last_game() noexcept {
+  if (!impl::get_ready()) {
+    return;
+  }
+
+  // Kept off the stack, the encoding of a long game takes a few KB
+  static std::array<uint8_t, max_encoded> s_encoded = {};
+
+  const Game&   game     = game::get_last_history();
+  const int64_t start_us = esp_timer_get_time();
+  const size_t  size     = encode(game, s_encoded);
+  const int64_t end_us   = esp_timer_get_time();
+
+  if (size == 0 || !impl::get_ring().append(std::span(s_encoded).first(size))) {
+    ESP_LOGE("History", "Storing the last game failed");
+    return;
+  }
+
+  ESP_LOGI("History",
+           "%u hits%s in %u bytes, %u bytes as plain structs, encoded in %lld "
+           "us",
+           static_cast<unsigned int>(game.hit_count),
+           game.truncated ? " (truncated)" : "",
+           static_cast<unsigned int>(size),
+           static_cast<unsigned int>(game.hit_count * sizeof(Hit)),
+           static_cast<long long>(end_us - start_us));
+}
+
+/**
+ * @brief Streams every stored game to the log, the oldest first.
+ *
+ * One line per chunk of at most 64 bytes, read from flash one chunk at a time:
+ * the sequence number of the game, the offset of the chunk in the encoded game
+ * and the chunk in hex. The lines of a game joined decode with `decode`.
+ */
+void export_games() noexcept {
+  constexpr char digits[] = "0123456789abcdef";
+
+  const bool streamed = impl::get_ready() &&
+  impl::get_ring().stream([&digits](const uint32_t                 sequence,
+                                    const size_t                   offset,
+                                    const std::span<const uint8_t> chunk) {
+    std::array<char, 2 * 64 + 1> hex = {};
+    for (size_t i = 0; i < chunk.size() && 2 * i + 1 < hex.size(); ++i) {
+      hex[2 * i]     = digits[chunk[i] >> 4U];
+      hex[2 * i + 1] = digits[chunk[i] & 0x0FU];
+    }
+    ESP_LOGI("History",
+             "Game %lu %04x %s",
+             static_cast<unsigned long>(sequence),
+             static_cast<unsigned int>(offset),
+             hex.data());
+  });
+
+  if (!streamed) {
+    ESP_LOGE("History", "Exporting the stored games failed");
+  }
+}
+
+}    // namespace app::history
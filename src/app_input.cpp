@@ -0,0 +1,530 @@
+#include "app_input.hpp"
+
+#include "app_buttons.hpp"
+#include "app_input_mcp.hpp"
+#include "app_input_sampler.hpp"
+#include "config.hpp"
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <freertos/projdefs.h>
+#include <freertos/queue.h>
+#include <hal/cpu_hal.h>
+#include <hal/gpio_types.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace app::input {
+namespace impl {
+
+// Bits of the enable mask, one per button group. The group of a pin is encoded
+// in the ISR argument next to the GPIO number.
+enum Group : uint8_t {
+  GroupStart   = 1U << 0U,
+  GroupPlayers = 1U << 1U
+};
+
+constexpr inline uintptr_t isr_arg_group_shift = 8;
+
+using QueueStorage =
+std::array<uint8_t, sizeof(Event) * config::game::input_queue_size>;
+
+[[nodiscard]] static QueueHandle_t& get_gpio_queue() noexcept {
+  static StaticQueue_t s_static_queue_handle = {};
+  static QueueStorage  s_queue_storage       = {};
+
+  static QueueHandle_t s_queue_handle =
+  xQueueCreateStatic(config::game::input_queue_size,
+                     sizeof(Event),
+                     s_queue_storage.data(),
+                     &s_static_queue_handle);
+
+  return s_queue_handle;
+}
+
+[[nodiscard]] static BatchStats& get_stats() noexcept {
+  static BatchStats s_stats = {};
+  return s_stats;
+}
+
+// Updated by the ISRs, hence kept apart from the task owned statistics
+struct IsrCounters {
+  std::atomic_uint32_t dropped;
+  std::atomic_uint32_t edge_calls;
+  std::atomic_uint32_t edge_cycles;
+};
+
+[[nodiscard]] static IsrCounters& get_isr_counters() noexcept {
+  static IsrCounters s_isr_counters = {};
+  return s_isr_counters;
+}
+
+// The switches of a round measured once at boot: removing and adding the
+// handlers like the input did before the phase mask, and the phase switches
+// that replace them
+struct PhaseTiming {
+  uint32_t handler_cycles;
+  uint32_t mask_cycles;
+  uint8_t  handler_calls;
+};
+
+[[nodiscard]] static PhaseTiming& get_phase_timing() noexcept {
+  static PhaseTiming s_phase_timing = {};
+  return s_phase_timing;
+}
+
+[[nodiscard]] static std::atomic<Mode>& get_mode() noexcept {
+  static std::atomic<Mode> s_mode = Mode::Edge;
+  return s_mode;
+}
+
+static void record_received(const Event& event, const int64_t now_us) noexcept {
+  const int64_t queue_time_us = now_us - event.timestamp_us;
+
+  BatchStats& stats          = get_stats();
+  stats.total_queue_time_us += queue_time_us;
+  if (queue_time_us > stats.max_queue_time_us) {
+    stats.max_queue_time_us = queue_time_us;
+  }
+}
+
+/**
+ * @brief Returns the mask of button groups the ISRs currently forward.
+ *
+ * Only ever written by `set_phase` and read by `isr_buttons_gpio`, a single
+ * byte so the load in the ISR is lock free.
+ */
+[[nodiscard]] static std::atomic_uint8_t& get_enable_mask() noexcept {
+  static std::atomic_uint8_t s_enable_mask = 0;
+  return s_enable_mask;
+}
+
+[[nodiscard]] constexpr static uint8_t get_phase_mask(Phase phase) noexcept {
+  switch (phase) {
+    case Phase::Start:
+      return GroupStart;
+    case Phase::Players:
+      return GroupPlayers;
+    case Phase::Disabled:
+    default:
+      return 0;
+  }
+}
+
+[[nodiscard]] constexpr static Group get_group(uint8_t gpio_num) noexcept {
+  return buttons::classify(gpio_num).kind == buttons::Kind::Start
+         ? GroupStart
+         : GroupPlayers;
+}
+
+/**
+ * @brief Queues an event from ISR context if its group is enabled.
+ *
+ * @param event The pressed button and the time of the press.
+ * @param group The button group of the pressed button.
+ * @param task_woken Set to pdTRUE if a higher priority task was woken.
+ */
+static void IRAM_ATTR queue_from_isr(const Event& event,
+                                     const uint8_t group,
+                                     BaseType_t&   task_woken) noexcept {
+  // Drop presses of buttons that are not part of the current phase
+  if ((get_enable_mask().load(std::memory_order_relaxed) & group) == 0) {
+    return;
+  }
+
+  if (xQueueSendFromISR(get_gpio_queue(), &event, &task_woken) != pdTRUE) {
+    get_isr_counters().dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief ISR handler for button GPIO interrupts.
+ *
+ * This function is called when a button GPIO interrupt occurs. If the group of
+ * the button is enabled it sends the GPIO number with a timestamp to the queue
+ * and yields from the ISR if a higher priority task was woken.
+ *
+ * @param gpio_arg GPIO number in the low byte, button group in the next byte.
+ */
+static void IRAM_ATTR isr_buttons_gpio(void* gpio_arg) noexcept {
+  const uint32_t begin_cycles = cpu_hal_get_cycle_count();
+
+  const auto arg   = reinterpret_cast<uintptr_t>(gpio_arg);
+  const auto group = static_cast<uint8_t>(arg >> isr_arg_group_shift);
+
+  const Event event = {esp_timer_get_time(), static_cast<uint8_t>(arg)};
+
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  // Send the event to the queue from the ISR
+  queue_from_isr(event, group, higher_priority_task_woken);
+
+  IsrCounters& counters = get_isr_counters();
+  counters.edge_calls.fetch_add(1, std::memory_order_relaxed);
+  counters.edge_cycles.fetch_add(cpu_hal_get_cycle_count() - begin_cycles,
+                                 std::memory_order_relaxed);
+
+  // Yield from the ISR if a higher priority task was woken
+  if (higher_priority_task_woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+/**
+ * @brief Enables or disables the edge interrupts of all native button pins.
+ */
+static void set_native_interrupts(const bool enabled) noexcept {
+  const auto set = [enabled](const uint8_t pin) noexcept {
+    enabled ? gpio_intr_enable(static_cast<gpio_num_t>(pin))
+            : gpio_intr_disable(static_cast<gpio_num_t>(pin));
+  };
+
+  set(config::gpio::start_in);
+
+  for (const auto& station : config::stations::stations) {
+    for (const uint8_t& pin : station.buttons_in) {
+      if (buttons::is_native(pin)) {
+        set(pin);
+      }
+    }
+  }
+}
+
+static void attach_isr(const uint8_t pin, const Group group) noexcept {
+  const uintptr_t arg = static_cast<uintptr_t>(pin) |
+                        (static_cast<uintptr_t>(group) << isr_arg_group_shift);
+
+  gpio_isr_handler_add(static_cast<gpio_num_t>(pin),
+                       isr_buttons_gpio,
+                       reinterpret_cast<void*>(arg));
+}
+
+/**
+ * @brief Times a round of phase switches both ways, once.
+ *
+ * Before the phase mask a round added and removed the handler of every button:
+ * the start button around the attract mode and the player buttons around the
+ * game. The round of the mask switches to Start, Disabled, Players and
+ * Disabled. Runs before the first phase is set, no press can be lost while a
+ * handler is removed.
+ */
+static void measure_phase_switch() noexcept {
+  PhaseTiming& timing = get_phase_timing();
+
+  const auto reattach = [&timing](const uint8_t pin,
+                                  const Group   group) noexcept {
+    gpio_isr_handler_remove(static_cast<gpio_num_t>(pin));
+    attach_isr(pin, group);
+    timing.handler_calls = static_cast<uint8_t>(timing.handler_calls + 2);
+  };
+
+  const uint32_t begin_cycles = cpu_hal_get_cycle_count();
+  reattach(config::gpio::start_in, GroupStart);
+  for (const auto& station : config::stations::stations) {
+    for (const uint8_t& pin : station.buttons_in) {
+      if (buttons::is_native(pin)) {
+        reattach(pin, GroupPlayers);
+      }
+    }
+  }
+  const uint32_t handler_end_cycles = cpu_hal_get_cycle_count();
+
+  set_phase(Phase::Start);
+  set_phase(Phase::Disabled);
+  set_phase(Phase::Players);
+  set_phase(Phase::Disabled);
+
+  timing.handler_cycles = handler_end_cycles - begin_cycles;
+  timing.mask_cycles    = cpu_hal_get_cycle_count() - handler_end_cycles;
+}
+
+}    // namespace impl
+
+/**
+ * @brief Attaches the ISR handlers for all buttons.
+ *
+ * The handlers are attached once at boot and stay attached, the phase set with
+ * `set_phase` decides which presses reach the queue. Player buttons on the
+ * button expander are read by its own task, which is only started if a station
+ * has buttons there. Requires the GPIO ISR service to be installed.
+ */
+void init() noexcept {
+  // Make sure the queue exists before the first interrupt can fire
+  static_cast<void>(impl::get_gpio_queue());
+
+  impl::attach_isr(config::gpio::start_in, impl::GroupStart);
+
+  for (const auto& station : config::stations::stations) {
+    for (const uint8_t& pin : station.buttons_in) {
+      if (buttons::is_native(pin)) {
+        impl::attach_isr(pin, impl::GroupPlayers);
+      }
+    }
+  }
+
+  if constexpr (buttons::uses_expander) {
+    mcp::init();
+  }
+
+  impl::measure_phase_switch();
+
+  if constexpr (config::input::sample_by_default) {
+    set_mode(Mode::Sampled);
+  }
+}
+
+/**
+ * @brief Switches between edge interrupts and timer sampling at runtime.
+ *
+ * The edge interrupts of the native button pins are disabled while sampling
+ * so every press is reported by exactly one path. Only `init` calls it, with
+ * `config::input::sample_by_default`.
+ *
+ * @param mode The mode to switch to.
+ */
+void set_mode(Mode mode) noexcept {
+  if (mode == impl::get_mode().load()) {
+    return;
+  }
+
+  if (mode == Mode::Sampled) {
+    impl::set_native_interrupts(false);
+    sampler::start(config::input::sample_rate_hz);
+  } else {
+    sampler::stop();
+    impl::set_native_interrupts(true);
+  }
+
+  impl::get_mode().store(mode);
+}
+
+[[nodiscard]] Mode get_mode() noexcept {
+  return impl::get_mode().load();
+}
+
+/**
+ * @brief Switches the group of buttons that is forwarded to the input queue.
+ *
+ * Events of the previous phase that were not consumed yet are discarded so a
+ * phase never sees presses made before it began.
+ *
+ * @param phase The phase to switch to.
+ */
+void set_phase(Phase phase) noexcept {
+  impl::get_enable_mask().store(impl::get_phase_mask(phase),
+                                std::memory_order_relaxed);
+  xQueueReset(impl::get_gpio_queue());
+}
+
+/**
+ * @brief Queues a press that was detected outside of an ISR.
+ *
+ * Used by input backends that read buttons from a task. The press is subject
+ * to the same phase gating as the presses of the GPIO ISRs.
+ *
+ * @param event The pressed button and the time of the press.
+ */
+void post(const Event& event) noexcept {
+  const uint8_t group = impl::get_group(event.gpio_num);
+  if ((impl::get_enable_mask().load(std::memory_order_relaxed) & group) == 0) {
+    return;
+  }
+
+  if (xQueueSend(impl::get_gpio_queue(), &event, 0) != pdTRUE) {
+    impl::get_isr_counters().dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Queues a press that was detected in an ISR other than the edge ISRs.
+ *
+ * Used by the timer sampling. The caller yields if `task_woken` is set.
+ *
+ * @param event The pressed button and the time of the press.
+ * @param task_woken Set to pdTRUE if a higher priority task was woken.
+ */
+void IRAM_ATTR post_from_isr(const Event& event,
+                             BaseType_t&  task_woken) noexcept {
+  impl::queue_from_isr(event, impl::get_group(event.gpio_num), task_woken);
+}
+
+/**
+ * @brief Wakes the task blocked in `receive_batch` without a press.
+ *
+ * Used by timers that need the game loop to run, the wake up is queued in
+ * front of any pending press. If the queue is full the receiver is not
+ * blocked anyway.
+ */
+void wake() noexcept {
+  const Event event = {esp_timer_get_time(), wake_gpio_num};
+  static_cast<void>(xQueueSendToFront(impl::get_gpio_queue(), &event, 0));
+}
+
+/**
+ * @brief Receives the next button press of the current phase.
+ *
+ * @param event Receives the pressed button and the time of the press.
+ * @param timeout Maximum number of ticks to wait for a press.
+ * @return true if a press was received, false on timeout or wake up.
+ */
+[[nodiscard]] bool receive(Event& event, TickType_t timeout) noexcept {
+  return xQueueReceive(impl::get_gpio_queue(), &event, timeout) == pdTRUE &&
+         event.gpio_num != wake_gpio_num;
+}
+
+/**
+ * @brief Receives all pending button presses of the current phase at once.
+ *
+ * Blocks until the first press arrives or the timeout expires, then drains
+ * every further press already queued without blocking again, so a burst of
+ * presses is handled in one pass instead of one loop round per press.
+ *
+ * @param events Receives the presses in the order they were queued.
+ * @param timeout Maximum number of ticks to wait for the first press.
+ * @return The number of presses written to `events`, 0 on timeout or wake up.
+ */
+[[nodiscard]] size_t receive_batch(std::span<Event> events,
+                                   TickType_t       timeout) noexcept {
+  if (events.empty() ||
+      xQueueReceive(impl::get_gpio_queue(), &events[0], timeout) != pdTRUE) {
+    return 0;
+  }
+
+  size_t received = 1;
+  while (received < events.size() &&
+         xQueueReceive(impl::get_gpio_queue(), &events[received], 0) ==
+         pdTRUE) {
+    ++received;
+  }
+
+  // Drop the wake ups, they only had to end the blocking receive
+  size_t count = 0;
+  for (size_t i = 0; i < received; ++i) {
+    if (events[i].gpio_num != wake_gpio_num) {
+      events[count++] = events[i];
+    }
+  }
+
+  if (count == 0) {
+    return 0;
+  }
+
+  const int64_t now_us = esp_timer_get_time();
+  for (size_t i = 0; i < count; ++i) {
+    impl::record_received(events[i], now_us);
+  }
+
+  BatchStats& stats = impl::get_stats();
+  ++stats.batches;
+  stats.events += static_cast<uint32_t>(count);
+  if (count > stats.max_batch_size) {
+    stats.max_batch_size = static_cast<uint8_t>(count);
+  }
+
+  return count;
+}
+
+/**
+ * @brief Returns the number of events waiting in the input queue.
+ */
+[[nodiscard]] size_t get_queue_depth() noexcept {
+  return uxQueueMessagesWaiting(impl::get_gpio_queue());
+}
+
+/**
+ * @brief Returns the batch and queue statistics since the last reset.
+ */
+[[nodiscard]] BatchStats get_batch_stats() noexcept {
+  const impl::IsrCounters& counters = impl::get_isr_counters();
+
+  BatchStats stats      = impl::get_stats();
+  stats.dropped         = counters.dropped.load(std::memory_order_relaxed);
+  stats.edge_isr_calls  = counters.edge_calls.load(std::memory_order_relaxed);
+  stats.edge_isr_cycles = counters.edge_cycles.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void reset_batch_stats() noexcept {
+  impl::IsrCounters& counters = impl::get_isr_counters();
+
+  impl::get_stats() = {};
+  counters.dropped.store(0, std::memory_order_relaxed);
+  counters.edge_calls.store(0, std::memory_order_relaxed);
+  counters.edge_cycles.store(0, std::memory_order_relaxed);
+  sampler::reset_stats();
+
+  if constexpr (buttons::uses_expander) {
+    mcp::reset_stats();
+  }
+}
+
+/**
+ * @brief Logs the batch statistics, those of the active mode and those of the
+ * button expander if it is used.
+ */
+void log_stats() noexcept {
+  const BatchStats stats = get_batch_stats();
+  ESP_LOGI("Input",
+           "%lu events in %lu batches (max %u), queue time avg %lld us max "
+           "%lld us, %lu dropped",
+           static_cast<unsigned long>(stats.events),
+           static_cast<unsigned long>(stats.batches),
+           static_cast<unsigned int>(stats.max_batch_size),
+           static_cast<long long>(
+           stats.events > 0 ? stats.total_queue_time_us / stats.events : 0),
+           static_cast<long long>(stats.max_queue_time_us),
+           static_cast<unsigned long>(stats.dropped));
+
+  // The queue time covers the whole path from press to dequeue, including
+  // the debounce delay of the sampling mode
+  if (get_mode() == Mode::Sampled) {
+    const sampler::Stats sampler_stats = sampler::get_stats();
+    ESP_LOGI("Input",
+             "Sampled: %lu samples, %lu events, ISR avg %llu cycles max %lu "
+             "cycles",
+             static_cast<unsigned long>(sampler_stats.samples),
+             static_cast<unsigned long>(sampler_stats.events),
+             static_cast<unsigned long long>(
+             sampler_stats.samples > 0
+             ? sampler_stats.total_cycles / sampler_stats.samples
+             : 0),
+             static_cast<unsigned long>(sampler_stats.max_cycles));
+  } else {
+    ESP_LOGI("Input",
+             "Edge: %lu ISR calls, ISR avg %lu cycles",
+             static_cast<unsigned long>(stats.edge_isr_calls),
+             static_cast<unsigned long>(
+             stats.edge_isr_calls > 0
+             ? stats.edge_isr_cycles / stats.edge_isr_calls
+             : 0));
+  }
+
+  const impl::PhaseTiming& timing = impl::get_phase_timing();
+  ESP_LOGI("Input",
+           "Phase switches of a round: %lu cycles by mask, %lu cycles by %u "
+           "handler add and remove calls",
+           static_cast<unsigned long>(timing.mask_cycles),
+           static_cast<unsigned long>(timing.handler_cycles),
+           static_cast<unsigned int>(timing.handler_calls));
+
+  if constexpr (buttons::uses_expander) {
+    const mcp::Stats mcp_stats = mcp::get_stats();
+    ESP_LOGI("Input",
+             "MCP: %lu reads (%lu failed), %lu events, read to event avg %lld "
+             "us max %lld us",
+             static_cast<unsigned long>(mcp_stats.reads),
+             static_cast<unsigned long>(mcp_stats.failed_reads),
+             static_cast<unsigned long>(mcp_stats.events),
+             static_cast<long long>(
+             mcp_stats.reads > 0 ? mcp_stats.total_latency_us / mcp_stats.reads
+                                 : 0),
+             static_cast<long long>(mcp_stats.max_latency_us));
+  }
+}
+
+}    // namespace app::input
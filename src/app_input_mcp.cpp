@@ -0,0 +1,266 @@
+#include "app_input_mcp.hpp"
+
+#include "app_buttons.hpp"
+#include "app_input.hpp"
+#include "config.hpp"
+#include <Adafruit_I2CDevice.h>
+#include <Adafruit_MCP23X17.h>
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <hal/gpio_types.h>
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+
+namespace app::input::mcp {
+namespace impl {
+
+// INTFA, INTFB, INTCAPA and INTCAPB are consecutive with IOCON.BANK = 0, so a
+// single read starting at INTFA returns all of them
+constexpr inline uint8_t  register_intf_a = MCP23XXX_INTF << 1U;
+constexpr inline size_t   burst_length    = 4;
+constexpr inline uint32_t task_stack_size = 4096;
+constexpr inline uint32_t task_priority   = 5;
+
+// Reads per wake while INT stays low, then the task yields for a tick so a
+// line that does not release cannot starve the game loop
+constexpr inline size_t max_reads_per_wake = 8;
+// Wait before reading again after a failed I2C read
+constexpr inline uint32_t failure_backoff_ms = 50;
+
+[[nodiscard]] static Adafruit_MCP23X17& get_mcp_buttons() noexcept {
+  static Adafruit_MCP23X17 s_mcp_buttons;
+  return s_mcp_buttons;
+}
+
+// Raw device for the burst read, the MCP class only reads single registers
+[[nodiscard]] static Adafruit_I2CDevice& get_i2c_buttons() noexcept {
+  static Adafruit_I2CDevice s_i2c_buttons(config::i2c::address_buttons);
+  return s_i2c_buttons;
+}
+
+[[nodiscard]] static TaskHandle_t& get_task() noexcept {
+  static TaskHandle_t s_task = nullptr;
+  return s_task;
+}
+
+[[nodiscard]] static Stats& get_stats() noexcept {
+  static Stats s_stats = {};
+  return s_stats;
+}
+
+/**
+ * @brief Returns the low 32 bits of the time of the oldest unread INT edge.
+ *
+ * Written by the ISR, taken by the read task. 0 means no edge is pending, a
+ * timestamp that happens to be 0 is stored as 1.
+ */
+[[nodiscard]] static std::atomic_uint32_t& get_edge_us() noexcept {
+  static std::atomic_uint32_t s_edge_us = 0;
+  return s_edge_us;
+}
+
+/**
+ * @brief ISR handler for the INT line of the button MCP23017.
+ *
+ * I2C cannot be used from an ISR, so this only records the time of the edge
+ * and wakes the read task.
+ */
+static void IRAM_ATTR isr_buttons_int(void* /*arg*/) noexcept {
+  const uint32_t now_us   = static_cast<uint32_t>(esp_timer_get_time()) | 1U;
+  uint32_t       expected = 0;
+  get_edge_us().compare_exchange_strong(expected,
+                                        now_us,
+                                        std::memory_order_relaxed);
+
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  vTaskNotifyGiveFromISR(get_task(), &higher_priority_task_woken);
+
+  if (higher_priority_task_woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+[[nodiscard]] static bool is_int_asserted() noexcept {
+  return gpio_get_level(static_cast<gpio_num_t>(config::gpio::buttons_int)) ==
+         0;
+}
+
+/**
+ * @brief Reads the interrupt flags and captures of both banks and queues a
+ * press event for every button that went low.
+ *
+ * Reading INTCAP also clears the interrupt on the expander.
+ *
+ * @return False if the I2C read failed, the edge time is kept for the retry.
+ */
+[[nodiscard]] static bool read_and_post() noexcept {
+  const int64_t now_us = esp_timer_get_time();
+  // Rebuild the full edge time from its low 32 bits
+  const uint32_t edge_low_us =
+  get_edge_us().exchange(0, std::memory_order_relaxed);
+  const int64_t edge_us =
+  edge_low_us == 0
+  ? now_us
+  : now_us - static_cast<int64_t>(static_cast<uint32_t>(now_us) - edge_low_us);
+
+  std::array<uint8_t, burst_length> registers = {};
+  if (!get_i2c_buttons().write_then_read(&register_intf_a,
+                                         1,
+                                         registers.data(),
+                                         registers.size())) {
+    ++get_stats().failed_reads;
+
+    // Unless a newer edge came in meanwhile, which cannot be older
+    uint32_t expected = 0;
+    get_edge_us().compare_exchange_strong(expected,
+                                          edge_low_us,
+                                          std::memory_order_relaxed);
+    return false;
+  }
+
+  const auto intf =
+  static_cast<uint16_t>(registers[0] | (registers[1] << 8U));
+  const auto intcap =
+  static_cast<uint16_t>(registers[2] | (registers[3] << 8U));
+
+  // The buttons pull their pin low, so only flagged pins captured low are
+  // presses, releases are ignored
+  auto pressed = static_cast<uint16_t>(intf & ~intcap);
+
+  while (pressed != 0) {
+    const auto pin = static_cast<size_t>(std::countr_zero(pressed));
+    pressed        = static_cast<uint16_t>(pressed & (pressed - 1U));
+
+    input::post(
+    {edge_us, static_cast<uint8_t>(config::mcp::buttons_first_id + pin)});
+    ++get_stats().events;
+  }
+
+  Stats& stats = get_stats();
+  ++stats.reads;
+
+  const int64_t latency_us  = esp_timer_get_time() - edge_us;
+  stats.total_latency_us   += latency_us;
+  if (latency_us > stats.max_latency_us) {
+    stats.max_latency_us = latency_us;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads the expander on every INT edge.
+ *
+ * A change during the read keeps INT low without a new edge, so the task reads
+ * until the expander released the line. After `max_reads_per_wake` reads it
+ * yields for a tick and goes on, after a failed read it sleeps for
+ * `failure_backoff_ms` and retries. A bus or expander fault then costs the
+ * game loop one failed transfer per back off instead of the whole CPU.
+ */
+[[noreturn]] static void task_read_buttons(void* /*arg*/) noexcept {
+  TickType_t wait_ticks = portMAX_DELAY;
+  uint32_t   failures   = 0;
+
+  while (true) {
+    static_cast<void>(ulTaskNotifyTake(pdTRUE, wait_ticks));
+
+    bool   read  = true;
+    size_t reads = 0;
+    do {
+      read = read_and_post();
+    } while (read && is_int_asserted() && ++reads < max_reads_per_wake);
+
+    if (!read) {
+      if (failures == 0) {
+        ESP_LOGE("MCP",
+                 "Reading the buttons failed, retrying every %lu ms",
+                 static_cast<unsigned long>(failure_backoff_ms));
+      }
+      ++failures;
+
+      // Edges during the back off are picked up by the retry right after it
+      vTaskDelay(failure_backoff_ms / portTICK_PERIOD_MS);
+      wait_ticks = 0;
+      continue;
+    }
+
+    if (failures > 0) {
+      ESP_LOGW("MCP",
+               "Reading the buttons works again after %lu failed reads",
+               static_cast<unsigned long>(failures));
+      failures = 0;
+    }
+    wait_ticks = is_int_asserted() ? 1 : portMAX_DELAY;
+  }
+}
+
+static void init_int_pin(const uint8_t pin) noexcept {
+  gpio_set_direction(static_cast<gpio_num_t>(pin), GPIO_MODE_INPUT);
+  gpio_set_intr_type(static_cast<gpio_num_t>(pin), GPIO_INTR_NEGEDGE);
+  gpio_isr_handler_add(static_cast<gpio_num_t>(pin), isr_buttons_int, nullptr);
+}
+
+}    // namespace impl
+
+/**
+ * @brief Initializes the button MCP23017 and starts the task reading it.
+ *
+ * All 16 pins are inputs with pull-ups and interrupt on change. INTB is
+ * mirrored onto INTA, one active low push-pull line to the ESP32. Requires the
+ * GPIO ISR service to be installed.
+ */
+void init() noexcept {
+  Adafruit_MCP23X17& mcp = impl::get_mcp_buttons();
+
+  if (!mcp.begin_I2C(config::i2c::address_buttons) ||
+      !impl::get_i2c_buttons().begin()) {
+    ESP_LOGE("MCP",
+             "Failed to initialize MCP for buttons, i2c address: 0x%x",
+             config::i2c::address_buttons);
+    vTaskDelay(3000 / portTICK_PERIOD_MS);
+    std::terminate();
+  }
+
+  mcp.setupInterrupts(true, false, LOW);
+  for (uint8_t pin = 0; pin < buttons::expander_pin_count; ++pin) {
+    mcp.pinMode(pin, INPUT_PULLUP);
+    mcp.setupInterruptPin(pin, CHANGE);
+  }
+
+  static StaticTask_t                              s_task_buffer = {};
+  static std::array<StackType_t, impl::task_stack_size> s_task_stack  = {};
+
+  impl::get_task() = xTaskCreateStatic(impl::task_read_buttons,
+                                       "mcp_buttons",
+                                       impl::task_stack_size,
+                                       nullptr,
+                                       impl::task_priority,
+                                       s_task_stack.data(),
+                                       &s_task_buffer);
+
+  impl::init_int_pin(config::gpio::buttons_int);
+
+  // Release INT in case a button changed before the handlers were attached
+  mcp.clearInterrupts();
+}
+
+/**
+ * @brief Returns the read statistics since the last reset.
+ */
+[[nodiscard]] Stats get_stats() noexcept {
+  return impl::get_stats();
+}
+
+void reset_stats() noexcept {
+  impl::get_stats() = {};
+}
+
+}    // namespace app::input::mcp
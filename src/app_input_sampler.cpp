@@ -0,0 +1,236 @@
+#include "app_input_sampler.hpp"
+
+#include "app_buttons.hpp"
+#include "app_input.hpp"
+#include "config.hpp"
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <hal/cpu_hal.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+
+#include <Arduino.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace app::input::sampler {
+namespace impl {
+
+// The start button is always native, the player buttons on the button
+// expander are not sampled
+constexpr inline size_t pin_count = 1 + buttons::native_player_count;
+
+[[nodiscard]] constexpr static std::array<uint8_t, pin_count>
+make_pins() noexcept {
+  std::array<uint8_t, pin_count> pins = {config::gpio::start_in};
+
+  if constexpr (pin_count > 1) {
+    size_t index = 1;
+    for (const auto& station : config::stations::stations) {
+      for (const uint8_t pin : station.buttons_in) {
+        if (buttons::is_native(pin)) {
+          pins.at(index++) = pin;
+        }
+      }
+    }
+  }
+
+  return pins;
+}
+
+constexpr inline std::array<uint8_t, pin_count> pins = make_pins();
+
+// Debounce state of one pin, the counter integrates towards `threshold` while
+// the pin reads low and back towards 0 while it reads high
+struct Integrator {
+  int64_t first_low_us;
+  uint8_t counter;
+  bool    pressed;
+};
+
+[[nodiscard]] static std::array<Integrator, pin_count>&
+get_integrators() noexcept {
+  static std::array<Integrator, pin_count> s_integrators = {};
+  return s_integrators;
+}
+
+[[nodiscard]] static hw_timer_t*& get_timer() noexcept {
+  static hw_timer_t* s_timer = nullptr;
+  return s_timer;
+}
+
+[[nodiscard]] static uint8_t& get_threshold() noexcept {
+  static uint8_t s_threshold = 1;
+  return s_threshold;
+}
+
+// Updated from the ISR only, read by the game task for reporting. At 2 kHz
+// the cycle total would wrap a 32-bit counter within an hour, it is 64 bits
+// wide and guarded by `get_cycles_lock` as the ESP32 has no 64-bit atomics.
+struct AtomicStats {
+  std::atomic_uint32_t samples;
+  std::atomic_uint32_t events;
+  std::atomic_uint32_t max_cycles;
+  uint64_t             total_cycles;
+};
+
+[[nodiscard]] static AtomicStats& get_stats() noexcept {
+  static AtomicStats s_stats = {};
+  return s_stats;
+}
+
+[[nodiscard]] static portMUX_TYPE& get_cycles_lock() noexcept {
+  static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+  return s_lock;
+}
+
+/**
+ * @brief Timer ISR sampling all button pins.
+ *
+ * Both GPIO input registers are read once per sample. A pin is reported as
+ * pressed when its integrator reaches the threshold, with the time of the
+ * first low sample so the timestamps match those of the edge interrupts.
+ */
+static void IRAM_ATTR isr_sample() noexcept {
+  const uint32_t begin_cycles = cpu_hal_get_cycle_count();
+  const int64_t  now_us       = esp_timer_get_time();
+
+  // GPIO 0 to 31 and GPIO 32 to 39 in one shot
+  const uint64_t levels =
+  static_cast<uint64_t>(REG_READ(GPIO_IN_REG)) |
+  (static_cast<uint64_t>(REG_READ(GPIO_IN1_REG) & 0xFFU) << 32U);
+
+  std::array<Integrator, pin_count>& integrators = get_integrators();
+  const uint8_t                      threshold   = get_threshold();
+  BaseType_t higher_priority_task_woken          = pdFALSE;
+  uint32_t   events                              = 0;
+
+  for (size_t i = 0; i < pin_count; ++i) {
+    Integrator& integrator = integrators[i];
+    const bool  low        = ((levels >> pins[i]) & 1U) == 0;
+
+    if (low) {
+      if (integrator.counter == 0) {
+        integrator.first_low_us = now_us;
+      }
+      if (integrator.counter < threshold) {
+        ++integrator.counter;
+      }
+      if (integrator.counter == threshold && !integrator.pressed) {
+        integrator.pressed = true;
+        input::post_from_isr({integrator.first_low_us, pins[i]},
+                             higher_priority_task_woken);
+        ++events;
+      }
+    } else if (integrator.counter > 0) {
+      --integrator.counter;
+      if (integrator.counter == 0) {
+        integrator.pressed = false;
+      }
+    }
+  }
+
+  AtomicStats& stats = get_stats();
+  stats.samples.fetch_add(1, std::memory_order_relaxed);
+  stats.events.fetch_add(events, std::memory_order_relaxed);
+
+  const uint32_t cycles = cpu_hal_get_cycle_count() - begin_cycles;
+  portENTER_CRITICAL_ISR(&get_cycles_lock());
+  stats.total_cycles += cycles;
+  portEXIT_CRITICAL_ISR(&get_cycles_lock());
+  if (cycles > stats.max_cycles.load(std::memory_order_relaxed)) {
+    stats.max_cycles.store(cycles, std::memory_order_relaxed);
+  }
+
+  if (higher_priority_task_woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+}    // namespace impl
+
+/**
+ * @brief Starts sampling the button pins with the hardware timer.
+ *
+ * The debounce threshold is derived from the rate so the debounce time stays
+ * at `config::input::sample_debounce_us`.
+ *
+ * @param rate_hz The sample rate, clamped to the configured range.
+ */
+void start(uint32_t rate_hz) noexcept {
+  stop();
+
+  rate_hz = std::clamp(rate_hz,
+                       config::input::sample_rate_min_hz,
+                       config::input::sample_rate_max_hz);
+
+  const uint32_t threshold =
+  rate_hz * config::input::sample_debounce_us / 1'000'000U;
+  impl::get_threshold() = static_cast<uint8_t>(
+  std::clamp<uint32_t>(threshold, 1, std::numeric_limits<uint8_t>::max()));
+
+  impl::get_integrators() = {};
+
+  // 80 MHz APB clock divided by 80 gives a 1 us timer tick
+  hw_timer_t* timer = timerBegin(config::input::sample_timer_number, 80, true);
+  timerAttachInterrupt(timer, impl::isr_sample, true);
+  timerAlarmWrite(timer, 1'000'000U / rate_hz, true);
+  timerAlarmEnable(timer);
+  impl::get_timer() = timer;
+
+  ESP_LOGI("Input",
+           "Sampling %u pins at %lu Hz, debounce %u samples",
+           static_cast<unsigned int>(impl::pin_count),
+           static_cast<unsigned long>(rate_hz),
+           static_cast<unsigned int>(impl::get_threshold()));
+}
+
+/**
+ * @brief Stops the sampling timer, does nothing if it is not running.
+ */
+void stop() noexcept {
+  hw_timer_t*& timer = impl::get_timer();
+  if (timer == nullptr) {
+    return;
+  }
+
+  timerAlarmDisable(timer);
+  timerDetachInterrupt(timer);
+  timerEnd(timer);
+  timer = nullptr;
+}
+
+/**
+ * @brief Returns the sampling statistics since the last reset.
+ */
+[[nodiscard]] Stats get_stats() noexcept {
+  const impl::AtomicStats& stats = impl::get_stats();
+
+  portENTER_CRITICAL(&impl::get_cycles_lock());
+  const uint64_t total_cycles = stats.total_cycles;
+  portEXIT_CRITICAL(&impl::get_cycles_lock());
+
+  return {stats.samples.load(std::memory_order_relaxed),
+          stats.events.load(std::memory_order_relaxed),
+          total_cycles,
+          stats.max_cycles.load(std::memory_order_relaxed)};
+}
+
+void reset_stats() noexcept {
+  impl::AtomicStats& stats = impl::get_stats();
+  stats.samples.store(0, std::memory_order_relaxed);
+  stats.events.store(0, std::memory_order_relaxed);
+  stats.max_cycles.store(0, std::memory_order_relaxed);
+
+  portENTER_CRITICAL(&impl::get_cycles_lock());
+  stats.total_cycles = 0;
+  portEXIT_CRITICAL(&impl::get_cycles_lock());
+}
+
+}    // namespace app::input::sampler
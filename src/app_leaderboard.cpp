@@ -0,0 +1,192 @@
+#include "app_leaderboard.hpp"
+
+#include "app_append_log.hpp"
+#include "app_game.hpp"
+#include "app_partition_storage.hpp"
+#include "app_top_list.hpp"
+#include "config.hpp"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace app::leaderboard {
+namespace impl {
+
+// A score and the sequence number of its entry in the log
+struct Ranked {
+  uint32_t sequence;
+  Score    score;
+};
+
+// Higher score first, then the faster mean reaction, then the earlier game
+struct Better {
+  [[nodiscard]] bool operator()(const Ranked& lhs,
+                                const Ranked& rhs) const noexcept {
+    if (lhs.score.score != rhs.score.score) {
+      return lhs.score.score > rhs.score.score;
+    }
+    if (lhs.score.reaction_ms != rhs.score.reaction_ms) {
+      return lhs.score.reaction_ms < rhs.score.reaction_ms;
+    }
+    return lhs.score.game < rhs.score.game;
+  }
+};
+
+using TopScores = TopList<Ranked, config::leaderboard::top_count, Better>;
+using ScoreLog  = AppendLog<Score, PartitionStorage>;
+
+// A compaction interrupted by a reset is redone on top of its partial copy
+static_assert(2 * config::leaderboard::top_count < ScoreLog::sector_entries,
+              "The leaderboard must fit into a sector twice");
+
+[[nodiscard]] static PartitionStorage& get_storage() noexcept {
+  static PartitionStorage s_storage = {};
+  return s_storage;
+}
+
+[[nodiscard]] static ScoreLog& get_log() noexcept {
+  static ScoreLog s_log {get_storage()};
+  return s_log;
+}
+
+[[nodiscard]] static TopScores& get_top_scores() noexcept {
+  static TopScores s_top_scores = {};
+  return s_top_scores;
+}
+
+// Set once the log is loaded, scores are neither stored nor ranked before
+[[nodiscard]] static bool& get_ready() noexcept {
+  static bool s_ready = false;
+  return s_ready;
+}
+
+[[nodiscard]] static uint32_t& get_next_game() noexcept {
+  static uint32_t s_next_game = 0;
+  return s_next_game;
+}
+
+/**
+ * @brief Returns whether an entry of the log is on the leaderboard, only those
+ * survive a compaction.
+ */
+[[nodiscard]] static bool is_live(const uint32_t sequence,
+                                  const Score& /*score*/) noexcept {
+  return std::ranges::any_of(get_top_scores().items(),
+                             [sequence](const Ranked& ranked) noexcept {
+                               return ranked.sequence == sequence;
+                             });
+}
+
+static void rank(const uint32_t sequence, const Score& score) noexcept {
+  // Copies of an entry share its sequence number
+  if (!is_live(sequence, score)) {
+    static_cast<void>(get_top_scores().insert({sequence, score}));
+  }
+}
+
+}    // namespace impl
+
+/**
+ * @brief Rebuilds the leaderboard from the log in flash.
+ *
+ * Every intact entry is ranked into the top scores, which takes a few
+ * milliseconds for the whole partition. Logs an error and leaves the
+ * leaderboard disabled if the partition is missing or cannot be read.
+ */
+void init() noexcept {
+  const int64_t start_us = esp_timer_get_time();
+
+  size_t     entries = 0;
+  const bool loaded =
+  impl::get_storage().open(config::leaderboard::partition) &&
+  impl::get_log().load([&entries](const uint32_t sequence,
+                                  const Score&   score) noexcept {
+    ++entries;
+    impl::rank(sequence, score);
+    impl::get_next_game() = std::max(impl::get_next_game(), score.game + 1);
+  });
+  if (!loaded) {
+    ESP_LOGE("Leaderboard",
+             "Partition %s is missing or unreadable, scores are not kept",
+             config::leaderboard::partition);
+    return;
+  }
+
+  impl::get_ready() = true;
+  ESP_LOGI("Leaderboard",
+           "Rebuilt from %u entries in %lld us",
+           static_cast<unsigned int>(entries),
+           static_cast<long long>(esp_timer_get_time() - start_us));
+}
+
+/**
+ * @brief Appends the scores of the last game to the log and ranks them.
+ *
+ * Players who did not score are left out, as are scores the log failed to
+ * store.
+ */
+void add_last_game() noexcept {
+  if (!impl::get_ready()) {
+    return;
+  }
+
+  const game::FinalScore scores = game::get_last_final_score();
+  const uint32_t         game   = impl::get_next_game()++;
+
+  for (size_t station = 0; station < scores.size(); ++station) {
+    if (scores[station] == 0) {
+      continue;
+    }
+
+    const uint32_t reaction_ms =
+    game::get_last_reaction_stats(station).mean_us / 1000;
+    const Score score = {
+    game,
+    static_cast<uint16_t>(
+    std::min<uint32_t>(reaction_ms, std::numeric_limits<uint16_t>::max())),
+    static_cast<uint8_t>(station),
+    scores[station]};
+
+    // Ranked once it is stored, so the board never shows a score the log
+    // lost. A compaction on the way keeps the score it pushes off the board,
+    // the next one drops it.
+    const uint32_t sequence = impl::get_log().get_next_sequence();
+    if (!impl::get_log().append(score, impl::is_live)) {
+      ESP_LOGE("Leaderboard",
+               "Writing game %lu failed",
+               static_cast<unsigned long>(game));
+      continue;
+    }
+    impl::rank(sequence, score);
+  }
+}
+
+void log() noexcept {
+  const Top top = get_top();
+
+  for (size_t i = 0; i < top.size; ++i) {
+    const Score& score = top.scores[i];
+    ESP_LOGI("Leaderboard",
+             "%2u. player %u: %u points, reaction %u ms, game %lu",
+             static_cast<unsigned int>(i + 1),
+             static_cast<unsigned int>(score.station + 1),
+             static_cast<unsigned int>(score.score),
+             static_cast<unsigned int>(score.reaction_ms),
+             static_cast<unsigned long>(score.game));
+  }
+}
+
+[[nodiscard]] Top get_top() noexcept {
+  Top top = {};
+  for (const impl::Ranked& ranked : impl::get_top_scores().items()) {
+    top.scores[top.size++] = ranked.score;
+  }
+  return top;
+}
+
+}    // namespace app::leaderboard
@@ -0,0 +1,237 @@
+#include "app_loadgen.hpp"
+
+#include "app_game.hpp"
+#include "app_game_core.hpp"
+#include "app_histogram.hpp"
+#include "app_input.hpp"
+#include "config.hpp"
+#include <esp_log.h>
+#include <esp_random.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace app::loadgen {
+namespace impl {
+
+// The game loop runs at the priority of the Arduino loop task, the simulated
+// players must not preempt it or spamming would starve the game
+constexpr inline uint32_t task_priority = 1;
+
+constexpr inline int64_t idle_reaction_us = std::numeric_limits<int64_t>::max();
+
+constexpr inline BotProfile profile = get_profile(config::loadgen::profile);
+
+// One simulated player, presses `target` once `due_us` is reached
+struct Bot {
+  uint8_t target;
+  int64_t due_us;
+};
+
+// Written by the player task, read by `finish`
+struct Counters {
+  std::atomic_uint32_t presses;
+  std::atomic_uint32_t max_queue_depth;
+};
+
+[[nodiscard]] static Counters& get_counters() noexcept {
+  static Counters s_counters = {};
+  return s_counters;
+}
+
+[[nodiscard]] static std::atomic_bool& get_running() noexcept {
+  static std::atomic_bool s_running = false;
+  return s_running;
+}
+
+[[nodiscard]] static TaskHandle_t& get_task() noexcept {
+  static TaskHandle_t s_task = nullptr;
+  return s_task;
+}
+
+[[nodiscard]] static int64_t sample_reaction_us() noexcept {
+  const uint32_t spread = profile.reaction_max_us - profile.reaction_min_us;
+  return profile.reaction_min_us +
+         (spread > 0 ? esp_random() % (spread + 1) : 0);
+}
+
+/**
+ * @brief Presses the target of a player, or with the miss rate of the profile
+ * one of the other buttons of that player.
+ *
+ * @param offset Moves the press on by this many buttons, the presses of a
+ * burst sweep the buttons of the player.
+ */
+static void press(const size_t  player,
+                  const uint8_t target,
+                  const uint8_t offset) noexcept {
+  const auto& buttons = config::stations::stations.at(player).buttons_in;
+
+  size_t button = target;
+  if (esp_random() % 100 < profile.miss_percent) {
+    button = target + 1 + esp_random() % (buttons.size() - 1);
+  }
+  button = (button + offset) % buttons.size();
+
+  input::post({esp_timer_get_time(), buttons.at(button)});
+
+  Counters& counters = get_counters();
+  counters.presses.fetch_add(1, std::memory_order_relaxed);
+
+  const auto depth = static_cast<uint32_t>(input::get_queue_depth());
+  if (depth > counters.max_queue_depth.load(std::memory_order_relaxed)) {
+    counters.max_queue_depth.store(depth, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Runs the simulated players while a load run is active.
+ *
+ * Every player reacts to a new target after a reaction time drawn from the
+ * profile and presses again after another one if the target did not move,
+ * so a dropped or missed press is retried like a person would. A turn is
+ * `burst` presses posted back to back, each on the next button.
+ */
+[[noreturn]] static void task_play(void* /*arg*/) noexcept {
+  while (true) {
+    static_cast<void>(ulTaskNotifyTake(pdTRUE, portMAX_DELAY));
+
+    std::array<Bot, game::core::player_count> bots = {};
+    for (Bot& bot : bots) {
+      bot = {std::numeric_limits<uint8_t>::max(), idle_reaction_us};
+    }
+
+    while (get_running().load(std::memory_order_relaxed)) {
+      const game::Targets targets = game::get_current_targets();
+      if (targets.front() == game::no_target) {
+        vTaskDelay(1);
+        continue;
+      }
+
+      int64_t now_us  = esp_timer_get_time();
+      int64_t next_us = idle_reaction_us;
+
+      for (size_t player = 0; player < bots.size(); ++player) {
+        Bot&          bot    = bots.at(player);
+        const uint8_t target = targets.at(player);
+
+        if (target != bot.target) {
+          bot = {target, now_us + sample_reaction_us()};
+        }
+        if (now_us >= bot.due_us) {
+          for (uint8_t i = 0; i < profile.burst; ++i) {
+            press(player, target, i);
+          }
+          now_us     = esp_timer_get_time();
+          bot.due_us = now_us + sample_reaction_us();
+        }
+
+        next_us = std::min(next_us, bot.due_us);
+      }
+
+      // Sleep whole ticks, shorter waits only give the game loop its turn
+      const int64_t wait_ms = (next_us - now_us) / 1000;
+      if (wait_ms >= portTICK_PERIOD_MS) {
+        vTaskDelay(static_cast<TickType_t>(wait_ms / portTICK_PERIOD_MS));
+      } else {
+        taskYIELD();
+      }
+    }
+  }
+}
+
+}    // namespace impl
+
+/**
+ * @brief Starts a load run with the configured profile.
+ *
+ * The simulated players wait until the game lights the first targets and
+ * stop on their own when it ends. Call right before `game::play`, also for a
+ * resumed game.
+ */
+void start() noexcept {
+  if (impl::get_task() == nullptr) {
+    static StaticTask_t s_task_buffer = {};
+    static std::array<StackType_t, config::loadgen::task_stack_size>
+    s_task_stack = {};
+
+    impl::get_task() = xTaskCreateStatic(impl::task_play,
+                                         "loadgen",
+                                         config::loadgen::task_stack_size,
+                                         nullptr,
+                                         impl::task_priority,
+                                         s_task_stack.data(),
+                                         &s_task_buffer);
+  }
+
+  impl::Counters& counters = impl::get_counters();
+  counters.presses.store(0, std::memory_order_relaxed);
+  counters.max_queue_depth.store(0, std::memory_order_relaxed);
+
+  impl::get_running().store(true, std::memory_order_relaxed);
+  xTaskNotifyGive(impl::get_task());
+}
+
+/**
+ * @brief Ends the load run and checks it against the limits of the profile.
+ *
+ * Call right after `game::play` returned. The rate is taken over the game
+ * itself, from its first lit targets to the end its loop saw, so neither the
+ * countdown nor the end pattern dilute it. The verdict is logged as a single
+ * PASS or FAIL line so a script watching the serial monitor can act on it.
+ *
+ * @return The measurements of the run and whether it passed.
+ */
+[[nodiscard]] Report finish() noexcept {
+  impl::get_running().store(false, std::memory_order_relaxed);
+
+  const impl::Counters&   counters = impl::get_counters();
+  const input::BatchStats stats    = input::get_batch_stats();
+  const LatencyHistogram  latency  = game::get_last_service_latency();
+
+  Report report          = {};
+  report.presses         = counters.presses.load(std::memory_order_relaxed);
+  report.events          = stats.events;
+  report.dropped         = stats.dropped;
+  report.max_queue_depth = counters.max_queue_depth.load();
+  report.duration_us     = game::get_last_end_us() - game::get_last_lit_us();
+  report.events_per_s    = static_cast<uint32_t>(
+  int64_t {stats.events} * 1'000'000 /
+  std::max<int64_t>(report.duration_us, 1));
+  report.latency_p50_us = latency.percentile_us(50);
+  report.latency_p95_us = latency.percentile_us(95);
+  report.latency_p99_us = latency.percentile_us(99);
+
+  report.passed = report.events_per_s >= impl::profile.min_events_per_s &&
+                  report.dropped <= impl::profile.max_dropped &&
+                  report.latency_p99_us <= impl::profile.max_p99_us;
+
+  ESP_LOGI("Loadgen",
+           "%lu presses, %lu handled (%lu/s), %lu dropped, queue depth max "
+           "%u, press to next target p50 %lu us p95 %lu us p99 %lu us",
+           static_cast<unsigned long>(report.presses),
+           static_cast<unsigned long>(report.events),
+           static_cast<unsigned long>(report.events_per_s),
+           static_cast<unsigned long>(report.dropped),
+           static_cast<unsigned int>(report.max_queue_depth),
+           static_cast<unsigned long>(report.latency_p50_us),
+           static_cast<unsigned long>(report.latency_p95_us),
+           static_cast<unsigned long>(report.latency_p99_us));
+
+  if (report.passed) {
+    ESP_LOGI("Loadgen", "PASS");
+  } else {
+    ESP_LOGE("Loadgen", "FAIL");
+  }
+
+  return report;
+}
+
+}    // namespace app::loadgen
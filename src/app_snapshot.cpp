@@ -0,0 +1,154 @@
+#include "app_snapshot.hpp"
+
+#include "app_crc32.hpp"
+#include "app_game_core.hpp"
+#include "config.hpp"
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_system.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace app::snapshot {
+namespace impl {
+
+// Tells a snapshot from the random content RTC memory has after a power on
+constexpr inline uint32_t magic = 0x5246'4C58;
+
+struct Stored {
+  uint32_t             magic;
+  uint32_t             resumes;    // how often the game was resumed already
+  game::core::Snapshot snapshot;
+};
+
+static_assert(std::is_trivially_copyable_v<Stored>);
+
+// The stored snapshot followed by its CRC, as plain bytes so nothing
+// initializes them at boot
+using Bytes = std::array<uint8_t, sizeof(Stored) + sizeof(uint32_t)>;
+
+[[nodiscard]] static Bytes& get_bytes() noexcept {
+  alignas(uint32_t) static RTC_NOINIT_ATTR Bytes s_bytes;
+  return s_bytes;
+}
+
+// Resumes of the running game, carried into its next snapshots
+[[nodiscard]] static uint32_t& get_resumes() noexcept {
+  static uint32_t s_resumes = 0;
+  return s_resumes;
+}
+
+[[nodiscard]] static uint32_t get_crc(const Bytes& bytes) noexcept {
+  return crc32(std::span(bytes).first(sizeof(Stored)));
+}
+
+/**
+ * @brief Returns the name of a reset that cut a game short, nullptr for the
+ * resets a game does not survive: power on, reset button, restart and deep
+ * sleep.
+ */
+[[nodiscard]] static const char*
+get_unexpected_reset(const esp_reset_reason_t reason) noexcept {
+  switch (reason) {
+    case ESP_RST_PANIC:
+      return "panic";
+    case ESP_RST_INT_WDT:
+      return "interrupt watchdog";
+    case ESP_RST_TASK_WDT:
+      return "task watchdog";
+    case ESP_RST_WDT:
+      return "watchdog";
+    case ESP_RST_BROWNOUT:
+      return "brownout";
+    default:
+      return nullptr;
+  }
+}
+
+}    // namespace impl
+
+/**
+ * @brief Stores the snapshot of the running game.
+ *
+ * Called after every committed frame, so the copy and the CRC never delay
+ * the feedback of a press.
+ */
+void save(const game::core::Snapshot& snapshot) noexcept {
+  if constexpr (!config::game::resume_enabled) {
+    return;
+  }
+
+  const impl::Stored stored = {impl::magic, impl::get_resumes(), snapshot};
+  impl::Bytes&       bytes  = impl::get_bytes();
+
+  std::memcpy(bytes.data(), &stored, sizeof(stored));
+  const uint32_t crc = impl::get_crc(bytes);
+  std::memcpy(bytes.data() + sizeof(stored), &crc, sizeof(crc));
+}
+
+/**
+ * @brief Drops the snapshot, the game is over.
+ */
+void clear() noexcept {
+  if constexpr (!config::game::resume_enabled) {
+    return;
+  }
+
+  impl::get_bytes().fill(0);
+  impl::get_resumes() = 0;
+}
+
+/**
+ * @brief Returns the snapshot of the game an unexpected reset cut short.
+ *
+ * A snapshot is only taken up after a crash, a watchdog or a brownout, while
+ * its CRC holds and while the game was resumed less than `max_resumes` times,
+ * so a game that crashes the board again and again ends. Every other
+ * snapshot is dropped.
+ *
+ * @param snapshot Receives the snapshot.
+ * @return False if there is no game to resume.
+ */
+[[nodiscard]] bool restore(game::core::Snapshot& snapshot) noexcept {
+  if constexpr (!config::game::resume_enabled) {
+    return false;
+  }
+
+  const impl::Bytes& bytes  = impl::get_bytes();
+  impl::Stored       stored = {};
+  uint32_t           crc    = 0;
+  std::memcpy(&stored, bytes.data(), sizeof(stored));
+  std::memcpy(&crc, bytes.data() + sizeof(stored), sizeof(crc));
+
+  const char* const reset = impl::get_unexpected_reset(esp_reset_reason());
+  if (reset == nullptr || stored.magic != impl::magic ||
+      crc != impl::get_crc(bytes)) {
+    clear();
+    return false;
+  }
+
+  if (stored.resumes >= config::game::max_resumes) {
+    ESP_LOGW("Snapshot",
+             "Game cut short by a %s reset after %lu resumes, not resuming",
+             reset,
+             static_cast<unsigned long>(stored.resumes));
+    clear();
+    return false;
+  }
+
+  ESP_LOGI("Snapshot",
+           "Game cut short by a %s reset, resuming with %lld us left",
+           reset,
+           static_cast<long long>(stored.snapshot.remaining_us));
+
+  impl::get_resumes() = stored.resumes + 1;
+  snapshot            = stored.snapshot;
+  return true;
+}
+
+}    // namespace app::snapshot
@@ -0,0 +1,222 @@
+#include "app_controller.hpp"
+#include "app_game.hpp"
+#include "app_random.hpp"
+#include "config.hpp"
+#include "global.hpp"
+#include "led_patterns/app_led_pattern_check.hpp"
+#include "led_patterns/app_led_pattern_end.hpp"
+#include "led_patterns/app_led_pattern_general.hpp"
+#include "led_patterns/app_led_pattern_start.hpp"
+#include "test_led_cases.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+// Renders the LED patterns the way they were before they were compiled into
+// frames: the headers in led_patterns/ are the stage functions as they were,
+// the outputs they drive are recorded by the functions of `controller::gpio`
+// below, whose pin mapping is taken from the controller of that time. Prints
+// a line per stage for test_led_patterns to compare.
+
+namespace app {
+namespace {
+
+std::array<uint16_t, 4> s_ports = {};
+bool                    s_start = false;
+
+game::FinalScore        s_scores  = {};
+std::array<uint32_t, 2> s_mean_us = {};
+
+[[nodiscard]] constexpr std::array<bool, 7>
+get_segment_for_digit(const uint8_t digit) noexcept {
+  switch (digit) {
+    case 0:
+      return {true, true, true, true, true, true, false};
+    case 1:
+      return {false, true, true, false, false, false, false};
+    case 2:
+      return {true, true, false, true, true, false, true};
+    case 3:
+      return {true, true, true, true, false, false, true};
+    case 4:
+      return {false, true, true, false, false, true, true};
+    case 5:
+      return {true, false, true, true, false, true, true};
+    case 6:
+      return {true, false, true, true, true, true, true};
+    case 7:
+      return {true, true, true, false, false, false, false};
+    case 8:
+      return {true, true, true, true, true, true, true};
+    case 9:
+      return {true, true, true, true, false, true, true};
+    default:
+      return {false, false, false, false, false, false, false};
+  }
+}
+
+// The left and the right LED of a row
+[[nodiscard]] constexpr std::pair<uint8_t, uint8_t>
+get_row_pins(const Player player, const Row row) noexcept {
+  using namespace config::mcp;
+
+  const bool first = player == Player::Player1;
+  switch (row) {
+    case Row::Bottom:
+      return first ? std::pair {player1_out_left_bottom,
+                                player1_out_right_bottom}
+                   : std::pair {player2_out_left_bottom,
+                                player2_out_right_bottom};
+    case Row::MiddleBottom:
+      return first ? std::pair {player1_out_left_middle_bottom,
+                                player1_out_right_middle_bottom}
+                   : std::pair {player2_out_left_middle_bottom,
+                                player2_out_right_middle_bottom};
+    case Row::MiddleTop:
+      return first ? std::pair {player1_out_left_middle_top,
+                                player1_out_right_middle_top}
+                   : std::pair {player2_out_left_middle_top,
+                                player2_out_right_middle_top};
+    case Row::Top:
+    default:
+      return first ? std::pair {player1_out_left_top, player1_out_right_top}
+                   : std::pair {player2_out_left_top, player2_out_right_top};
+  }
+}
+
+template<size_t StageCount>
+void render(const char* const             name,
+            const size_t                  play,
+            const LedPattern<StageCount>& pattern) {
+  // The controller turned every output off before a pattern
+  s_ports = {};
+  s_start = false;
+
+  for (size_t stage = 0; stage < pattern.size(); ++stage) {
+    pattern[stage].first();
+    std::puts(test::led::format_stage(name,
+                                      play,
+                                      stage,
+                                      s_ports,
+                                      s_start,
+                                      pattern[stage].second)
+              .c_str());
+  }
+}
+
+}    // namespace
+
+namespace controller::gpio {
+
+void turn_on(const uint8_t pin, const Output output) noexcept {
+  if (output == Output::Gpio) {
+    s_start = s_start || pin == config::gpio::start_out;
+    return;
+  }
+  uint16_t& port = s_ports[static_cast<size_t>(output)];
+  port           = static_cast<uint16_t>(port | 1U << pin);
+}
+
+void turn_off(const uint8_t pin, const Output output) noexcept {
+  if (output == Output::Gpio) {
+    s_start = s_start && pin != config::gpio::start_out;
+    return;
+  }
+  uint16_t& port = s_ports[static_cast<size_t>(output)];
+  port           = static_cast<uint16_t>(port & ~(1U << pin));
+}
+
+void write_port(const uint16_t value, const Output output) noexcept {
+  if (output != Output::Gpio) {
+    s_ports[static_cast<size_t>(output)] = value;
+  }
+}
+
+void turn_on_row(const Player player, const Row row) noexcept {
+  const auto [left, right] = get_row_pins(player, row);
+  turn_on(left, Output::Players);
+  turn_on(right, Output::Players);
+}
+
+void turn_off_row(const Player player, const Row row) noexcept {
+  const auto [left, right] = get_row_pins(player, row);
+  turn_off(left, Output::Players);
+  turn_off(right, Output::Players);
+}
+
+void display_segment_number(uint8_t number,
+                            const SegmentDisplay display) noexcept {
+  if (number > 99) {
+    number = 99;
+  }
+
+  const std::array<bool, 7> left  = get_segment_for_digit(number / 10);
+  const std::array<bool, 7> right = get_segment_for_digit(number % 10);
+
+  uint32_t port = 0;
+  for (size_t i = 0; i < 7; ++i) {
+    port |= uint32_t {left.at(i)} << config::mcp::seg_left_pins.at(i);
+    port |= uint32_t {right.at(i)} << config::mcp::seg_right_pins.at(i);
+  }
+
+  // The displays follow the players port in the order of `Output`
+  s_ports[static_cast<size_t>(display) + 1] = static_cast<uint16_t>(port);
+}
+
+void turn_off_segment(const SegmentDisplay display) noexcept {
+  s_ports[static_cast<size_t>(display) + 1] = 0;
+}
+
+}    // namespace controller::gpio
+
+namespace controller::util {
+
+[[nodiscard]] gpio::PlayerPins get_random_player_pins(Player player) noexcept {
+  const config::stations::Station& station =
+  config::stations::stations.at(static_cast<size_t>(player));
+
+  const auto random_index = static_cast<uint8_t>(
+  get_random().below(config::stations::targets_per_station));
+
+  return {station.buttons_in.at(random_index),
+          station.leds_out.at(random_index)};
+}
+
+}    // namespace controller::util
+
+namespace game {
+
+[[nodiscard]] FinalScore get_last_final_score() noexcept {
+  return s_scores;
+}
+
+[[nodiscard]] ReactionStats get_last_reaction_stats(size_t player) noexcept {
+  return {0, 0, s_mean_us.at(player), 0, 0, 0};
+}
+
+}    // namespace game
+
+}    // namespace app
+
+int main() {
+  using namespace app;
+
+  get_random().seed(test::led::seed);
+
+  render("check", 0, led_pattern::check);
+  for (int play = 0; play < test::led::general_plays; ++play) {
+    render("general", static_cast<size_t>(play), led_pattern::general);
+  }
+  render("start", 0, led_pattern::start);
+
+  for (size_t play = 0; play < test::led::end_cases.size(); ++play) {
+    const test::led::EndCase& end_case = test::led::end_cases[play];
+    s_scores  = end_case.scores;
+    s_mean_us = end_case.mean_us;
+    render("end", play, led_pattern::end);
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+#ifndef ESP_REFLEX_TEST_CHECK_HPP
+#define ESP_REFLEX_TEST_CHECK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+
+// Checks of the host tests, a failed check is logged and fails the test with a
+// non-zero exit code once `finish` is reached
+
+namespace app::test {
+
+[[nodiscard]] inline int& get_failures() noexcept {
+  static int s_failures = 0;
+  return s_failures;
+}
+
+inline void expect(const bool condition, const char* const what) noexcept {
+  if (!condition) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    ++get_failures();
+  }
+}
+
+/**
+ * @brief Logs the verdict of a test.
+ *
+ * @return The exit code of the test.
+ */
+[[nodiscard]] inline int finish(const char* const name) noexcept {
+  const bool passed = get_failures() == 0;
+  std::printf("%s: %s\n", name, passed ? "PASS" : "FAIL");
+  return passed ? 0 : 1;
+}
+
+/**
+ * @brief Returns the time per operation of a benchmark in ns, the best of a
+ * few runs so a busy host does not skew it.
+ *
+ * @param operations The operations one run of the benchmark does.
+ * @param run Runs the benchmark once.
+ */
+template<typename Run>
+[[nodiscard]] double measure_ns(const size_t operations, Run&& run) noexcept {
+  constexpr int runs = 5;
+
+  double best_ns = std::numeric_limits<double>::max();
+  for (int i = 0; i < runs; ++i) {
+    const auto begin = std::chrono::steady_clock::now();
+    run();
+    const std::chrono::duration<double, std::nano> elapsed =
+    std::chrono::steady_clock::now() - begin;
+    best_ns = std::min(best_ns, elapsed.count());
+  }
+
+  return best_ns / static_cast<double>(operations);
+}
+
+}    // namespace app::test
+
+#endif    //ESP_REFLEX_TEST_CHECK_HPP
@@ -0,0 +1,82 @@
+#include "app_deadline_queue.hpp"
+#include "app_game_core.hpp"
+#include "app_random.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// The deadline heap against a sorted reference, and the cost of the push and
+// pop pairs the game loop does per wake up
+
+using app::test::expect;
+
+namespace {
+
+enum class Kind : uint8_t {
+  Tick,
+  End
+};
+
+constexpr size_t capacity = 8;
+
+using Queue = app::DeadlineQueue<Kind, capacity>;
+
+void check_order() noexcept {
+  app::Random random;
+  random.seed(1);
+
+  for (int round = 0; round < 1000; ++round) {
+    Queue                queue;
+    std::vector<int64_t> expected;
+
+    for (size_t i = 0; i < capacity; ++i) {
+      const int64_t due_us = random.below(1000);
+      expect(queue.push(due_us, Kind::Tick), "push below capacity");
+      expected.push_back(due_us);
+    }
+    expect(!queue.push(0, Kind::End), "push into a full queue fails");
+
+    std::ranges::sort(expected);
+    for (const int64_t due_us : expected) {
+      expect(queue.top().due_us == due_us, "top is the earliest deadline");
+      expect(queue.pop().due_us == due_us, "pop returns the earliest");
+    }
+    expect(queue.empty(), "every deadline popped");
+  }
+}
+
+/**
+ * @brief The clock tick of a running game, popped and pushed again on every
+ * wake up next to the end of the game.
+ */
+void bench_tick() noexcept {
+  constexpr size_t operations = 1'000'000;
+
+  int64_t    sum    = 0;
+  const auto per_op = app::test::measure_ns(operations, [&sum]() noexcept {
+    Queue queue;
+    static_cast<void>(queue.push(30'000'000, Kind::End));
+    static_cast<void>(queue.push(0, Kind::Tick));
+    for (size_t i = 0; i < operations; ++i) {
+      const app::Deadline<Kind> tick = queue.pop();
+      static_cast<void>(queue.push(tick.due_us + 1, Kind::Tick));
+      sum += tick.due_us;
+    }
+  });
+
+  std::printf("DeadlineQueue pop and push: %.2f ns (checksum %lld)\n",
+              per_op,
+              static_cast<long long>(sum));
+}
+
+}    // namespace
+
+int main() {
+  check_order();
+  bench_tick();
+  return app::test::finish("deadline_queue");
+}
@@ -0,0 +1,223 @@
+#include "app_game_core.hpp"
+#include "app_random.hpp"
+#include "config.hpp"
+#include "test_check.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// The cost of one event through `core::step` with the mode of the config
+// dispatched at compile time. The events of a few seeded games are recorded
+// first, so the benchmark times the core alone, and the scores the replay
+// shows are checked against its hits.
+
+namespace core = app::game::core;
+
+using app::test::expect;
+
+namespace {
+
+constexpr uint32_t game_count = 200;
+
+struct Game {
+  uint32_t                 seed;
+  std::vector<core::Event> events;
+};
+
+/**
+ * @brief Plays a game with presses on lit and unlit buttons every few tens of
+ * milliseconds and a Time event before each of them.
+ */
+[[nodiscard]] Game record(const uint32_t seed) noexcept {
+  static core::GameState    state;
+  static core::Actions      actions;
+  static core::TargetTables tables;
+  core::build_target_tables({}, tables);
+
+  app::Random random;
+  random.seed(seed);
+  app::Random players;
+  players.seed(~seed);
+
+  actions.clear();
+  core::start(state, 0, random, tables, actions);
+
+  Game    game   = {seed, {}};
+  int64_t now_us = 0;
+  while (!state.over) {
+    now_us += 20'000 + players.below(200'000);
+
+    const core::Event time = {core::EventKind::Time, 0, now_us};
+    actions.clear();
+    core::step(state, time, actions);
+    game.events.push_back(time);
+    if (state.over) {
+      break;
+    }
+
+    const auto    player = static_cast<uint8_t>(players.below(2));
+    const uint8_t target = players.below(8) == 0
+                           ? static_cast<uint8_t>(players.below(8))
+                           : state.target_indices[player];
+
+    const core::Event press = {
+      core::EventKind::Press,
+      config::stations::stations[player].buttons_in[target],
+      now_us};
+    actions.clear();
+    core::step(state, press, actions);
+    game.events.push_back(press);
+  }
+
+  return game;
+}
+
+/**
+ * @brief Replays a recorded game, checking that every hit shows the score of
+ * its player one up and that the game ends once with the shown scores.
+ */
+void check(const Game& game) noexcept {
+  static core::GameState    state;
+  static core::Actions      actions;
+  static core::TargetTables tables;
+  core::build_target_tables({}, tables);
+
+  app::Random random;
+  random.seed(game.seed);
+
+  actions.clear();
+  core::start(state, 0, random, tables, actions);
+
+  std::array<uint8_t, core::player_count> shown = {};
+  std::array<bool, core::player_count>    hit   = {};
+  size_t                                  ends  = 0;
+
+  for (const core::Event& event : game.events) {
+    actions.clear();
+    core::step(state, event, actions);
+
+    for (const core::Action& action : actions) {
+      switch (action.kind) {
+        case core::ActionKind::Hit:
+          hit[action.player] = true;
+          break;
+        case core::ActionKind::ShowScore:
+          if (hit[action.player]) {
+            expect(action.value == shown[action.player] + 1,
+                   "a hit scores one point");
+            hit[action.player] = false;
+          }
+          shown[action.player] = static_cast<uint8_t>(action.value);
+          break;
+        case core::ActionKind::End:
+          ++ends;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  expect(state.over && ends == 1, "the game ends once");
+  expect(shown == state.scores, "the last shown scores are the final ones");
+}
+
+/**
+ * @brief Returns the time the actions arm the timer for, -1 if they do not.
+ */
+[[nodiscard]] int64_t get_armed_us(const core::Actions& actions) noexcept {
+  int64_t armed_us = -1;
+  for (const core::Action& action : actions) {
+    if (action.kind == core::ActionKind::ArmTimer) {
+      armed_us = action.time_us;
+    }
+  }
+  return armed_us;
+}
+
+/**
+ * @brief Checks that a timer dropped from a full frame is armed by the next
+ * step, the game would wait for presses only otherwise.
+ */
+void check_full_frame() noexcept {
+  static core::GameState    state;
+  static core::GameState    reference;
+  static core::Actions      actions;
+  static core::TargetTables tables;
+  core::build_target_tables({}, tables);
+
+  app::Random random;
+  random.seed(1);
+  actions.clear();
+  core::start(state, 0, random, tables, actions);
+  reference = state;
+
+  // The first clock tick arms the timer for what is due next
+  const core::Event tick = {core::EventKind::Time, 0, core::second_us};
+  actions.clear();
+  core::step(reference, tick, actions);
+  const int64_t due_us = get_armed_us(actions);
+
+  actions.clear();
+  while (actions.push({core::ActionKind::ShowTime, 0, 0, 0})) {
+  }
+  core::step(state, tick, actions);
+  expect(actions.dropped > 1, "a full frame drops the actions of a step");
+
+  actions.clear();
+  core::step(state, {core::EventKind::Time, 0, core::second_us + 1}, actions);
+  expect(due_us > core::second_us && get_armed_us(actions) == due_us,
+         "a timer dropped from a full frame is armed by the next step");
+}
+
+[[nodiscard]] double bench_step(const std::vector<Game>& games) noexcept {
+  static core::GameState    state;
+  static core::Actions      actions;
+  static core::TargetTables tables;
+  core::build_target_tables({}, tables);
+
+  size_t events = 0;
+  for (const Game& game : games) {
+    events += game.events.size();
+  }
+
+  return app::test::measure_ns(events, [&] {
+    for (const Game& game : games) {
+      app::Random random;
+      random.seed(game.seed);
+
+      actions.clear();
+      core::start(state, 0, random, tables, actions);
+      for (const core::Event& event : game.events) {
+        actions.clear();
+        core::step(state, event, actions);
+      }
+    }
+  });
+}
+
+}    // namespace
+
+int main() {
+  std::vector<Game> games;
+  size_t            events = 0;
+  for (uint32_t seed = 1; seed <= game_count; ++seed) {
+    games.push_back(record(seed));
+    events += games.back().events.size();
+  }
+
+  for (const Game& game : games) {
+    check(game);
+  }
+  check_full_frame();
+
+  std::printf("%s mode, %zu events in %lu games: %.2f ns per event\n",
+              core::get_mode_name(),
+              events,
+              static_cast<unsigned long>(game_count),
+              bench_step(games));
+  return app::test::finish("game_core");
+}
@@ -0,0 +1,209 @@
+#include "app_game_core.hpp"
+#include "app_game_record.hpp"
+#include "app_random.hpp"
+#include "config.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+// Games are played like the game loop plays them, woken by the timer the core
+// arms or by presses that queued up meanwhile, and recorded. Each record goes
+// through an export and back and is replayed, which has to commit the same
+// frames action by action and end with the same scores.
+
+namespace core = app::game::core;
+
+using app::test::expect;
+
+namespace {
+
+constexpr uint32_t game_count = 300;
+
+using Frames = std::vector<std::vector<core::Action>>;
+
+struct Played {
+  Frames                                  frames;
+  std::array<uint8_t, core::player_count> scores;
+  int64_t                                 duration_us;
+};
+
+void add_frame(const core::Actions& actions, Frames& frames) noexcept {
+  frames.emplace_back(actions.begin(), actions.end());
+}
+
+[[nodiscard]] int64_t get_armed_us(const core::Actions& actions,
+                                   int64_t              armed_us) noexcept {
+  for (const core::Action& action : actions) {
+    if (action.kind == core::ActionKind::ArmTimer) {
+      armed_us = action.time_us;
+    }
+  }
+  return armed_us;
+}
+
+/**
+ * @brief Plays and records a game with learnt target times, a few presses on
+ * unlit buttons and a wake up latency of up to 300 us.
+ */
+[[nodiscard]] Played play(const uint32_t    seed,
+                          core::GameRecord& record) noexcept {
+  static core::GameState    state;
+  static core::Actions      actions;
+  static core::TargetTables tables;
+
+  app::Random players;
+  players.seed(seed * 7 + 1);
+
+  core::TargetTimes times_us = {};
+  for (auto& player_times : times_us) {
+    for (uint32_t& time_us : player_times) {
+      time_us = players.below(800'000);
+    }
+  }
+  core::build_target_tables(times_us, tables);
+
+  app::Random random;
+  random.seed(seed);
+  const int64_t go_us = 5'000'000 + seed;
+  record.begin(random.get_state(), go_us, times_us);
+
+  Played played = {};
+  actions.clear();
+  core::start(state, go_us, random, tables, actions);
+  record.commit(actions);
+  add_frame(actions, played.frames);
+
+  int64_t armed_us = get_armed_us(actions, go_us);
+
+  std::array<int64_t, core::player_count> press_us = {};
+  for (int64_t& due_us : press_us) {
+    due_us = go_us + 300'000 + players.below(500'000);
+  }
+
+  std::vector<std::pair<int64_t, uint8_t>> presses;
+  int64_t                                  now_us = go_us;
+  while (!state.over) {
+    const int64_t wake_us =
+    std::min(armed_us, *std::ranges::min_element(press_us));
+    now_us = wake_us + players.below(300);
+
+    presses.clear();
+    for (size_t player = 0; player < core::player_count; ++player) {
+      while (press_us[player] <= now_us) {
+        const uint8_t target =
+        players.below(5) == 0
+        ? static_cast<uint8_t>(players.below(core::target_count))
+        : state.target_indices[player];
+        presses.emplace_back(
+        press_us[player],
+        config::stations::stations[player].buttons_in[target]);
+        press_us[player] += 200'000 + players.below(900'000);
+      }
+    }
+    std::ranges::sort(presses);
+
+    actions.clear();
+    for (const auto& [time_us, gpio_num] : presses) {
+      const core::Event press = {core::EventKind::Press, gpio_num, time_us};
+      record.add(press);
+      core::step(state, {core::EventKind::Time, 0, time_us}, actions);
+      core::step(state, press, actions);
+    }
+
+    const core::Event time = {core::EventKind::Time, 0, now_us};
+    record.add(time);
+    core::step(state, time, actions);
+    record.commit(actions);
+    add_frame(actions, played.frames);
+    armed_us = get_armed_us(actions, armed_us);
+  }
+
+  played.scores      = state.scores;
+  played.duration_us = now_us - go_us;
+  return played;
+}
+
+[[nodiscard]] bool is_same(const core::Action& a,
+                           const core::Action& b) noexcept {
+  return a.kind == b.kind && a.player == b.player && a.value == b.value &&
+         a.time_us == b.time_us;
+}
+
+[[nodiscard]] bool is_same(const Frames& a, const Frames& b) noexcept {
+  return std::ranges::equal(a, b, [](const auto& x, const auto& y) {
+    return std::ranges::equal(x, y, [](const auto& p, const auto& q) {
+      return is_same(p, q);
+    });
+  });
+}
+
+/**
+ * @brief Replays a record read back from its exported bytes.
+ */
+[[nodiscard]] bool replay(const core::GameRecord& record,
+                          Played&                 replayed) noexcept {
+  static core::GameRecord   copy;
+  static core::GameState    state;
+  static core::Actions      actions;
+  static core::TargetTables tables;
+
+  copy.begin(record.get_seed(), record.get_start_us(), record.get_times_us());
+  const std::vector<uint8_t> exported(record.get_log().begin(),
+                                      record.get_log().end());
+  if (!copy.load(exported)) {
+    return false;
+  }
+
+  replayed = {};
+  const bool complete =
+  core::replay(copy, state, tables, actions, [&](const core::Actions& frame) {
+    add_frame(frame, replayed.frames);
+  });
+  replayed.scores = state.scores;
+  return complete;
+}
+
+}    // namespace
+
+int main() {
+  static core::GameRecord record;
+
+  size_t  max_bytes = 0;
+  size_t  sum_bytes = 0;
+  int64_t played_us = 0;
+  double  replay_ns = 0;
+  Played  replayed  = {};
+
+  for (uint32_t seed = 1; seed <= game_count; ++seed) {
+    const Played played = play(seed, record);
+
+    expect(!record.is_truncated(), "a game fits into its record");
+    expect(replay(record, replayed), "the whole record is replayed");
+    expect(is_same(played.frames, replayed.frames),
+           "the replay commits the frames of the game");
+    expect(played.scores == replayed.scores,
+           "the replay ends with the scores of the game");
+
+    max_bytes  = std::max(max_bytes, record.get_log().size());
+    sum_bytes += record.get_log().size();
+    played_us += played.duration_us;
+    replay_ns += app::test::measure_ns(1, [&] {
+      static_cast<void>(replay(record, replayed));
+    });
+  }
+
+  std::printf("Record bytes per game: %zu on average, %zu at most of %zu\n",
+              sum_bytes / game_count,
+              max_bytes,
+              core::GameRecord::Log {}.size());
+  std::printf("Replay: %.1f us per game, %.0fx real time\n",
+              replay_ns / game_count / 1000,
+              static_cast<double>(played_us) * 1000 / replay_ns);
+  return app::test::finish("game_record");
+}
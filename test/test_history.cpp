@@ -0,0 +1,208 @@
+#include "app_file_storage.hpp"
+#include "app_history_codec.hpp"
+#include "app_random.hpp"
+#include "app_record_ring.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <span>
+#include <vector>
+
+// The history codec round trip on random and extreme games, and the record
+// ring in a file over several boots: the stream hands back the newest records
+// oldest first, in chunks, byte for byte as they were appended.
+
+namespace history = app::history;
+
+using app::test::expect;
+
+namespace {
+
+constexpr const char* path         = "test_history.bin";
+constexpr size_t      sector_count = 8;
+
+using Ring  = app::RecordRing<app::FileStorage>;
+using Bytes = std::array<uint8_t, history::max_encoded>;
+
+[[nodiscard]] bool is_same(const history::Game& a,
+                           const history::Game& b) noexcept {
+  return a.duration_ms == b.duration_ms && a.hit_count == b.hit_count &&
+         a.truncated == b.truncated &&
+         std::ranges::equal(std::span(a.hits).first(a.hit_count),
+                            std::span(b.hits).first(b.hit_count),
+                            [](const history::Hit& x, const history::Hit& y) {
+                              return x.time_ms == y.time_ms &&
+                                     x.reaction_ms == y.reaction_ms &&
+                                     x.player == y.player &&
+                                     x.target == y.target;
+                            });
+}
+
+/**
+ * @brief Fills a game of the given number of hits a few hundred ms apart.
+ */
+void make_game(app::Random&   random,
+               const size_t   hit_count,
+               history::Game& game) noexcept {
+  game.clear();
+
+  uint32_t time_ms = 0;
+  for (size_t i = 0; i < hit_count; ++i) {
+    time_ms += 100 + random.below(700);
+    game.add({time_ms,
+              150 + random.below(600),
+              static_cast<uint8_t>(random.below(2)),
+              static_cast<uint8_t>(random.below(8))});
+  }
+  game.duration_ms = time_ms + random.below(1000);
+}
+
+void check_round_trip(const history::Game& game) noexcept {
+  static Bytes         bytes;
+  static history::Game decoded;
+
+  const size_t size = history::encode(game, bytes);
+  expect(size > 0, "a game fits into max_encoded bytes");
+  expect(history::decode(std::span(bytes).first(size), decoded) &&
+         is_same(game, decoded),
+         "a decoded game equals the encoded one");
+
+  if (size > 0) {
+    expect(!history::decode(std::span(bytes).first(size - 1), decoded),
+           "a cut off game does not decode");
+    expect(history::encode(game, std::span(bytes).first(size - 1)) == 0,
+           "encoding into too few bytes fails");
+  }
+}
+
+void check_codec() noexcept {
+  static history::Game game;
+
+  app::Random random;
+  random.seed(3);
+
+  for (int i = 0; i < 2000; ++i) {
+    make_game(random, random.below(history::max_hits + 1), game);
+    check_round_trip(game);
+  }
+
+  // Every hit with the largest values, times that go back and the last
+  // player and target
+  constexpr uint32_t max = std::numeric_limits<uint32_t>::max();
+  game.clear();
+  game.duration_ms = max;
+  for (size_t i = 0; i < history::max_hits; ++i) {
+    game.add({i % 2 == 0 ? max : 0,
+              max,
+              static_cast<uint8_t>((1U << history::impl::player_bits) - 1),
+              static_cast<uint8_t>((1U << history::impl::target_bits) - 1)});
+  }
+  check_round_trip(game);
+  expect(!game.truncated, "a game of max_hits hits is whole");
+
+  // A game with more hits than the cap, like one with penalties, keeps the
+  // first hits and says so
+  make_game(random, history::max_hits + 5, game);
+  expect(game.truncated && game.hit_count == history::max_hits,
+         "the hits past max_hits are dropped and the game is truncated");
+  check_round_trip(game);
+
+  game.clear();
+  expect(!game.truncated, "clear resets the truncation");
+  check_round_trip(game);
+}
+
+void check_ring() noexcept {
+  static history::Game game;
+  static Bytes         bytes;
+
+  std::remove(path);
+  app::FileStorage file(path, sector_count);
+
+  app::Random random;
+  random.seed(7);
+
+  std::map<uint32_t, std::vector<uint8_t>> appended;
+  uint32_t                                 sequence = 0;
+  double                                   encode_ns = 0;
+  size_t                                   encoded   = 0;
+
+  for (int boot = 0; boot < 20; ++boot) {
+    Ring ring(file);
+    expect(ring.load(), "the ring loads after every boot");
+
+    for (int i = 0; i < 25; ++i) {
+      make_game(random, 40 + random.below(120), game);
+
+      size_t size = 0;
+      encode_ns  += app::test::measure_ns(1, [&] {
+        size = history::encode(game, bytes);
+      });
+      encoded    += size;
+
+      const std::span<const uint8_t> record = std::span(bytes).first(size);
+      expect(ring.append(record), "a game is appended");
+      appended[++sequence].assign(record.begin(), record.end());
+    }
+
+    std::map<uint32_t, std::vector<uint8_t>> streamed;
+    uint32_t                                 last = 0;
+    expect(ring.stream([&](const uint32_t                 id,
+                           const size_t                   offset,
+                           const std::span<const uint8_t> chunk) {
+      std::vector<uint8_t>& record = streamed[id];
+      expect(offset == 0 ? id > last : id == last,
+             "records stream oldest first, each in one piece");
+      expect(offset == record.size() && chunk.size() <= 64,
+             "a record streams in consecutive chunks of at most 64 bytes");
+      record.insert(record.end(), chunk.begin(), chunk.end());
+      last = id;
+    }),
+           "the ring streams");
+
+    // The oldest sector is dropped as a whole, what is left runs up to the
+    // newest record without gaps
+    expect(!streamed.empty() && streamed.rbegin()->first == sequence &&
+           streamed.rbegin()->first - streamed.begin()->first + 1 ==
+           streamed.size(),
+           "the newest records stream without gaps");
+    expect(std::ranges::all_of(streamed,
+                               [&](const auto& entry) {
+                                 return appended[entry.first] == entry.second;
+                               }),
+           "a streamed record equals the appended bytes");
+    expect(std::ranges::all_of(streamed,
+                               [](const auto& entry) {
+                                 return history::decode(entry.second, game);
+                               }),
+           "a streamed record decodes");
+
+    if (boot == 19) {
+      std::printf("%zu of %lu games kept in %zu sectors\n",
+                  streamed.size(),
+                  static_cast<unsigned long>(sequence),
+                  sector_count);
+    }
+  }
+
+  std::printf("History: %zu bytes per game of 40 to 160 hits, %zu as plain "
+              "hits, %.0f ns to encode\n",
+              encoded / sequence,
+              sizeof(history::Hit) * 100,
+              encode_ns / sequence);
+  std::remove(path);
+}
+
+}    // namespace
+
+int main() {
+  check_codec();
+  check_ring();
+  return app::test::finish("history");
+}
@@ -0,0 +1,69 @@
+#ifndef ESP_REFLEX_TEST_LED_CASES_HPP
+#define ESP_REFLEX_TEST_LED_CASES_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// What the LED patterns are rendered with, by the stage functions the patterns
+// were before they were compiled into frames and by the frames. Each side
+// formats a line per stage, the lines have to match.
+
+namespace app::test::led {
+
+// Seeds the generator the random targets of the general pattern come from
+constexpr inline uint32_t seed = 12345;
+
+// Plays of the general pattern, each lights other random targets
+constexpr inline int general_plays = 50;
+
+struct EndCase {
+  std::array<uint8_t, 2>  scores;
+  std::array<uint32_t, 2> mean_us;    // mean reaction times of the players
+};
+
+// Wins, ties and scores and reaction times past what a display shows
+constexpr inline std::array<EndCase, 9> end_cases = {{
+  {{5, 3}, {250'000, 310'000}},
+  {{3, 5}, {0, 2'000'000}},
+  {{7, 7}, {99'999, 5}},
+  {{0, 0}, {0, 0}},
+  {{99, 12}, {990'000, 1'000'000}},
+  {{12, 99}, {123'456, 654'321}},
+  {{150, 3}, {10'000, 19'999}},
+  {{3, 150}, {4'000'000'000, 1}},
+  {{100, 100}, {500'000, 500'000}},
+}};
+
+/**
+ * @brief Returns the line of the outputs after a stage: the four expander
+ * ports, the start LED and the delay after the stage.
+ */
+[[nodiscard]] inline std::string
+format_stage(const char* const             pattern,
+             const size_t                  play,
+             const size_t                  stage,
+             const std::array<uint16_t, 4> ports,
+             const bool                    start,
+             const uint32_t                delay_ms) {
+  std::array<char, 96> line = {};
+  std::snprintf(line.data(),
+                line.size(),
+                "%s %zu.%zu: %04x %04x %04x %04x %d %lu",
+                pattern,
+                play,
+                stage,
+                static_cast<unsigned int>(ports[0]),
+                static_cast<unsigned int>(ports[1]),
+                static_cast<unsigned int>(ports[2]),
+                static_cast<unsigned int>(ports[3]),
+                start ? 1 : 0,
+                static_cast<unsigned long>(delay_ms));
+  return line.data();
+}
+
+}    // namespace app::test::led
+
+#endif    //ESP_REFLEX_TEST_LED_CASES_HPP
@@ -0,0 +1,167 @@
+#include "app_random.hpp"
+#include "config.hpp"
+#include "global.hpp"
+#include "led_patterns/app_led_pattern.hpp"
+#include "led_patterns/app_led_pattern_check.hpp"
+#include "led_patterns/app_led_pattern_end.hpp"
+#include "led_patterns/app_led_pattern_general.hpp"
+#include "led_patterns/app_led_pattern_start.hpp"
+#include "test_check.hpp"
+#include "test_led_cases.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// The compiled LED patterns against the stage functions they replace: every
+// stage of check, general, start and end has to drive every port and the
+// start LED like before, fills included. The stages of before are rendered
+// by led_patterns_before, whose path is the only argument.
+
+namespace led_pattern = app::led_pattern;
+
+using app::test::expect;
+
+namespace {
+
+struct Inputs {
+  app::Random             random;
+  std::array<uint8_t, 2>  scores;
+  std::array<uint32_t, 2> mean_us;
+};
+
+/**
+ * @brief Returns the port value of a fill like the controller does.
+ */
+[[nodiscard]] uint16_t get_fill(const led_pattern::Fill fill,
+                                const size_t            port,
+                                Inputs&                 inputs) noexcept {
+  switch (fill) {
+    case led_pattern::Fill::None:
+      return 0;
+    case led_pattern::Fill::Random: {
+      uint32_t pins = 0;
+      for (const config::stations::Station& station :
+           config::stations::stations) {
+        const uint32_t target =
+        inputs.random.below(config::stations::targets_per_station);
+        pins |= 1U << station.leds_out.at(target);
+      }
+      return static_cast<uint16_t>(pins);
+    }
+    case led_pattern::Fill::Score:
+    case led_pattern::Fill::Reaction:
+      break;
+  }
+
+  const size_t player = led_pattern::get_port_player(port);
+  if (player >= config::stations::stations.size()) {
+    return 0;
+  }
+
+  if (fill == led_pattern::Fill::Score) {
+    return led_pattern::get_number_port(inputs.scores.at(player));
+  }
+  return led_pattern::get_number_port(
+  static_cast<uint8_t>(std::min<uint32_t>(inputs.mean_us.at(player) / 10000,
+                                          99)));
+}
+
+template<size_t StageCount>
+void render(const char* const                 name,
+            const size_t                      play,
+            const app::LedPattern<StageCount>& pattern,
+            Inputs&                           inputs,
+            std::vector<std::string>&         lines) {
+  for (size_t stage = 0; stage < pattern.size(); ++stage) {
+    const led_pattern::Frame& frame = pattern[stage].frame;
+
+    std::array<uint16_t, led_pattern::port_count> ports = {};
+    for (size_t port = 0; port < ports.size(); ++port) {
+      ports[port] = static_cast<uint16_t>(
+      frame.ports[port] | get_fill(frame.fills[port], port, inputs));
+    }
+    lines.push_back(app::test::led::format_stage(
+    name, play, stage, ports, frame.start, pattern[stage].delay_ms));
+  }
+}
+
+[[nodiscard]] std::vector<std::string> render_frames() {
+  Inputs inputs = {};
+  inputs.random.seed(app::test::led::seed);
+
+  std::vector<std::string> lines;
+  render("check", 0, led_pattern::check, inputs, lines);
+  for (int play = 0; play < app::test::led::general_plays; ++play) {
+    render("general",
+           static_cast<size_t>(play),
+           led_pattern::general,
+           inputs,
+           lines);
+  }
+  render("start", 0, led_pattern::start, inputs, lines);
+
+  for (size_t play = 0; play < app::test::led::end_cases.size(); ++play) {
+    const app::test::led::EndCase& end_case = app::test::led::end_cases[play];
+    inputs.scores  = end_case.scores;
+    inputs.mean_us = end_case.mean_us;
+    render("end",
+           play,
+           led_pattern::get_end(end_case.scores),
+           inputs,
+           lines);
+  }
+  return lines;
+}
+
+[[nodiscard]] std::vector<std::string> read_lines(const char* const command) {
+  std::vector<std::string> lines;
+
+  std::FILE* const pipe = popen(command, "r");
+  if (pipe == nullptr) {
+    return lines;
+  }
+
+  std::array<char, 128> line = {};
+  while (std::fgets(line.data(), static_cast<int>(line.size()), pipe) !=
+         nullptr) {
+    std::string text = line.data();
+    if (!text.empty() && text.back() == '\n') {
+      text.pop_back();
+    }
+    lines.push_back(text);
+  }
+
+  expect(pclose(pipe) == 0, "led_patterns_before runs");
+  return lines;
+}
+
+}    // namespace
+
+int main(const int argc, const char* const* const argv) {
+  if (argc != 2) {
+    std::fprintf(stderr, "Usage: %s <led_patterns_before>\n", argv[0]);
+    return 2;
+  }
+
+  const std::vector<std::string> before = read_lines(argv[1]);
+  const std::vector<std::string> frames = render_frames();
+
+  expect(before.size() == frames.size(), "both sides render every stage");
+  for (size_t i = 0; i < std::min(before.size(), frames.size()); ++i) {
+    if (before[i] != frames[i]) {
+      std::fprintf(stderr,
+                   "before: %s\nframes: %s\n",
+                   before[i].c_str(),
+                   frames[i].c_str());
+      expect(false, "a frame drives the outputs like its stage function");
+    }
+  }
+
+  std::printf("%zu stages compared\n", frames.size());
+  return app::test::finish("led_patterns");
+}
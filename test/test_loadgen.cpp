@@ -0,0 +1,207 @@
+#include "app_game_core.hpp"
+#include "app_loadgen.hpp"
+#include "app_random.hpp"
+#include "config.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+// The load generator on a host: the simulated players of every profile press
+// through a queue the size of the input queue, a simulated game loop drains it
+// into `core::step` once per tick and the run is judged against the rate and
+// drop limits of the profile like on the device. The latency budget of a
+// profile is a device figure and only judged there, the host guards the cost
+// of a step against regressions instead. Every frame has to hold the actions
+// of a full batch, the Burst profile brings one each round. Exits non-zero if
+// a run fails.
+
+namespace core = app::game::core;
+
+using app::test::expect;
+
+namespace {
+
+// The game loop wakes up at least once per FreeRTOS tick
+constexpr int64_t tick_us = 1000;
+
+constexpr int64_t idle_us = std::numeric_limits<int64_t>::max();
+
+// Regression guard for the host time to step one press, far above what the
+// core takes so only a change of its cost fails it, not a noisy machine
+constexpr int64_t host_step_p99_ns = 50'000;
+
+struct Bot {
+  uint8_t target;
+  int64_t due_us;
+};
+
+struct Run {
+  uint32_t             presses;
+  uint32_t             events;
+  uint32_t             dropped;
+  size_t               max_queue_depth;
+  int64_t              duration_us;
+  std::vector<int64_t> press_ns;    // host time to step one press
+  uint32_t             full_batches;    // rounds that drained a full queue
+  size_t               actions_dropped;
+};
+
+[[nodiscard]] int64_t
+sample_reaction_us(const app::loadgen::BotProfile& profile,
+                   app::Random&                    random) noexcept {
+  const uint32_t spread = profile.reaction_max_us - profile.reaction_min_us;
+  return profile.reaction_min_us + random.below(spread + 1);
+}
+
+/**
+ * @brief Plays one game with the simulated players of a profile.
+ *
+ * A player takes at most one turn per tick, which is what the low priority
+ * player task of the device gets done while the game loop keeps up. A turn
+ * is `burst` presses at once, each on the next button.
+ */
+[[nodiscard]] Run play(const app::loadgen::BotProfile& profile,
+                       const uint32_t                  seed) noexcept {
+  static core::GameState    state;
+  static core::Actions      actions;
+  static core::TargetTables tables;
+  core::build_target_tables({}, tables);
+
+  app::Random random;
+  random.seed(seed);
+  app::Random players;
+  players.seed(~seed);
+
+  actions.clear();
+  core::start(state, 0, random, tables, actions);
+
+  std::array<Bot, core::player_count> bots = {};
+  bots.fill({std::numeric_limits<uint8_t>::max(), idle_us});
+
+  std::vector<core::Event> queue;
+  Run                      run = {};
+
+  int64_t now_us = 0;
+  for (; !state.over; now_us += tick_us) {
+    for (size_t player = 0; player < bots.size(); ++player) {
+      Bot&          bot    = bots[player];
+      const uint8_t target = state.target_indices[player];
+
+      if (target != bot.target) {
+        bot = {target, now_us + sample_reaction_us(profile, players)};
+      }
+      if (now_us < bot.due_us) {
+        continue;
+      }
+
+      const auto& buttons = config::stations::stations[player].buttons_in;
+      size_t      button  = target;
+      if (players.below(100) < profile.miss_percent) {
+        button = target + 1 + players.below(core::target_count - 1);
+      }
+
+      for (uint8_t i = 0; i < profile.burst; ++i) {
+        ++run.presses;
+        if (queue.size() < config::game::input_queue_size) {
+          queue.push_back({core::EventKind::Press,
+                           buttons[(button + i) % core::target_count],
+                           now_us});
+        } else {
+          ++run.dropped;
+        }
+      }
+      bot.due_us = now_us + sample_reaction_us(profile, players);
+    }
+    run.max_queue_depth = std::max(run.max_queue_depth, queue.size());
+    if (queue.size() == config::game::input_queue_size) {
+      ++run.full_batches;
+    }
+
+    // One round of the game loop, like `game::play`
+    actions.clear();
+    for (const core::Event& press : queue) {
+      const auto begin = std::chrono::steady_clock::now();
+      core::step(state, {core::EventKind::Time, 0, press.time_us}, actions);
+      core::step(state, press, actions);
+      run.press_ns.push_back(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - begin)
+      .count());
+      ++run.events;
+    }
+    queue.clear();
+
+    core::step(state, {core::EventKind::Time, 0, now_us}, actions);
+    run.actions_dropped += actions.dropped;
+  }
+
+  run.duration_us = now_us;
+  return run;
+}
+
+[[nodiscard]] int64_t get_percentile(std::vector<int64_t> values,
+                                     const size_t         percent) noexcept {
+  if (values.empty()) {
+    return 0;
+  }
+  const size_t index = (values.size() - 1) * percent / 100;
+  std::ranges::nth_element(values, values.begin() + static_cast<long>(index));
+  return values[index];
+}
+
+void check_profile(const config::loadgen::Profile id,
+                   const char* const              name) noexcept {
+  const app::loadgen::BotProfile profile = app::loadgen::get_profile(id);
+
+  for (uint32_t seed = 1; seed <= 5; ++seed) {
+    const Run     run          = play(profile, seed);
+    const int64_t p50_ns       = get_percentile(run.press_ns, 50);
+    const int64_t p99_ns       = get_percentile(run.press_ns, 99);
+    const auto    events_per_s = static_cast<uint32_t>(
+    int64_t {run.events} * 1'000'000 / std::max<int64_t>(run.duration_us, 1));
+
+    const bool passed = events_per_s >= profile.min_events_per_s &&
+                        run.dropped <= profile.max_dropped &&
+                        p99_ns <= host_step_p99_ns &&
+                        run.actions_dropped == 0;
+
+    std::printf("%s seed %u: %u presses, %u handled (%u/s), %u dropped, queue "
+                "depth max %zu in %u full batches, host step per press p50 "
+                "%lld ns p99 %lld ns, %zu actions dropped: %s\n",
+                name,
+                seed,
+                static_cast<unsigned int>(run.presses),
+                static_cast<unsigned int>(run.events),
+                static_cast<unsigned int>(events_per_s),
+                static_cast<unsigned int>(run.dropped),
+                run.max_queue_depth,
+                static_cast<unsigned int>(run.full_batches),
+                static_cast<long long>(p50_ns),
+                static_cast<long long>(p99_ns),
+                run.actions_dropped,
+                passed ? "PASS" : "FAIL");
+    expect(passed, name);
+
+    if (profile.burst >= config::game::input_queue_size) {
+      expect(run.full_batches > 0 && run.dropped > 0,
+             "a burst fills the input queue and drops the presses past it");
+    }
+  }
+}
+
+}    // namespace
+
+int main() {
+  check_profile(config::loadgen::Profile::Human, "Human");
+  check_profile(config::loadgen::Profile::Fast, "Fast");
+  check_profile(config::loadgen::Profile::Spam, "Spam");
+  check_profile(config::loadgen::Profile::Burst, "Burst");
+  return app::test::finish("loadgen");
+}
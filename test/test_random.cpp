@@ -0,0 +1,103 @@
+#include "app_random.hpp"
+#include "test_check.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// The generator against the reference output of xoshiro128++, the spread of
+// its bounded draws and the cost of a draw
+
+using app::test::expect;
+
+namespace {
+
+void check_reference() noexcept {
+  // First outputs of the reference implementation for the state 1, 2, 3, 4
+  constexpr std::array<uint32_t, 4> expected = {641,
+                                                1'573'767,
+                                                3'222'811'527,
+                                                3'517'856'514};
+
+  app::Random random {{1, 2, 3, 4}};
+  for (const uint32_t value : expected) {
+    expect(random.next() == value, "xoshiro128++ reference output");
+  }
+}
+
+void check_state() noexcept {
+  app::Random random;
+  random.seed(42);
+  static_cast<void>(random.next());
+
+  app::Random copy {random.get_state()};
+  for (int i = 0; i < 100; ++i) {
+    expect(copy.next() == random.next(), "a restored state replays");
+  }
+}
+
+/**
+ * @brief Draws every target equally often within 2 %, the current target of
+ * `below_except` never.
+ */
+void check_spread() noexcept {
+  constexpr uint32_t bound = 8;
+  constexpr uint32_t draws = 800'000;
+
+  app::Random random;
+  random.seed(7);
+
+  std::array<uint32_t, bound> below  = {};
+  std::array<uint32_t, bound> except = {};
+  for (uint32_t i = 0; i < draws; ++i) {
+    const uint32_t value = random.below(bound);
+    expect(value < bound, "below stays below its bound");
+    ++below[value];
+
+    const uint32_t other = random.below_except(bound, 3);
+    expect(other != 3 && other < bound, "below_except skips the current");
+    ++except[other];
+  }
+
+  for (uint32_t value = 0; value < bound; ++value) {
+    const auto near = [](const uint32_t count, const uint32_t mean) noexcept {
+      return std::abs(static_cast<int64_t>(count) - int64_t {mean}) <
+             int64_t {mean} / 50;
+    };
+    expect(near(below[value], draws / bound), "below is uniform");
+    if (value != 3) {
+      expect(near(except[value], draws / (bound - 1)),
+             "below_except is uniform over the others");
+    }
+  }
+
+  app::Random outside;
+  expect(outside.below_except(bound, bound) < bound,
+         "a current outside the range excludes nothing");
+}
+
+void bench_draw() noexcept {
+  constexpr size_t draws = 10'000'000;
+
+  app::Random random;
+  uint32_t    sum    = 0;
+  const auto  per_op = app::test::measure_ns(draws, [&]() noexcept {
+    for (size_t i = 0; i < draws; ++i) {
+      sum += random.below_except(8, sum & 7U);
+    }
+  });
+
+  std::printf("Random below_except: %.2f ns (checksum %u)\n", per_op, sum);
+}
+
+}    // namespace
+
+int main() {
+  check_reference();
+  check_state();
+  check_spread();
+  bench_draw();
+  return app::test::finish("random");
+}
@@ -0,0 +1,265 @@
+#include "app_append_log.hpp"
+#include "app_file_storage.hpp"
+#include "app_leaderboard.hpp"
+#include "app_random.hpp"
+#include "app_top_list.hpp"
+#include "config.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+// The leaderboard log in a file with the power cut at random writes and
+// erases, compactions included. Every boot rebuilds the top scores from the
+// log, they have to match the best of all scores whose append succeeded.
+
+using app::leaderboard::Score;
+using app::test::expect;
+
+namespace {
+
+constexpr const char* path           = "test_score_log.bin";
+constexpr size_t      sector_count   = 4;
+constexpr uint32_t    boot_count     = 400;
+constexpr uint32_t    games_per_boot = 60;
+
+// Like the leaderboard ranks them
+struct Ranked {
+  uint32_t sequence;
+  Score    score;
+};
+
+struct Better {
+  [[nodiscard]] bool operator()(const Ranked& lhs,
+                                const Ranked& rhs) const noexcept {
+    if (lhs.score.score != rhs.score.score) {
+      return lhs.score.score > rhs.score.score;
+    }
+    if (lhs.score.reaction_ms != rhs.score.reaction_ms) {
+      return lhs.score.reaction_ms < rhs.score.reaction_ms;
+    }
+    return lhs.score.game < rhs.score.game;
+  }
+};
+
+using TopScores = app::TopList<Ranked, config::leaderboard::top_count, Better>;
+
+/**
+ * @brief `FileStorage` that loses power in a write or an erase.
+ *
+ * The write the power is cut in stores a part of its bytes, the erase clears
+ * a part of its sector, everything after it fails until the next boot.
+ */
+class CutStorage {
+public:
+  static constexpr size_t sector_size = app::FileStorage::sector_size;
+
+  explicit CutStorage(app::FileStorage& file) noexcept : m_file(file) {}
+
+  // Cuts the power in the given write or erase from now, counting from 1
+  void cut_after(const uint32_t operations, const uint32_t seed) noexcept {
+    m_left = operations;
+    m_random.seed(seed);
+  }
+
+  /**
+   * @brief Cuts the power in a compaction, the given number of writes or
+   * erases after the next sector is opened, counting from 0.
+   */
+  void cut_in_compaction(const uint32_t operations,
+                         const uint32_t seed) noexcept {
+    m_compaction = true;
+    cut_after(operations + 1, seed);
+  }
+
+  // Power comes back with the next boot
+  void boot() noexcept {
+    m_left       = 0;
+    m_compaction = false;
+    m_counting   = false;
+    m_cut        = false;
+  }
+
+  // Whether the power is still to be cut
+  [[nodiscard]] bool is_armed() const noexcept {
+    return m_left > 0;
+  }
+
+  [[nodiscard]] uint32_t get_cut_compactions() const noexcept {
+    return m_cut_compactions;
+  }
+
+  [[nodiscard]] size_t sector_count() const noexcept {
+    return m_file.sector_count();
+  }
+
+  [[nodiscard]] bool read(const size_t             offset,
+                          const std::span<uint8_t> data) noexcept {
+    return m_file.read(offset, data);
+  }
+
+  [[nodiscard]] bool write(const size_t                   offset,
+                           const std::span<const uint8_t> data) noexcept {
+    // The log opens a sector with a write of its generation
+    if (m_compaction && offset % sector_size == 0) {
+      m_compaction = false;
+      m_counting   = true;
+    }
+
+    if (!is_powered()) {
+      const auto size = static_cast<uint32_t>(data.size());
+      static_cast<void>(
+      m_file.write(offset, data.first(m_random.below(size))));
+      return false;
+    }
+    return m_file.write(offset, data);
+  }
+
+  [[nodiscard]] bool erase(const size_t sector) noexcept {
+    if (!is_powered()) {
+      // The start of the sector is erased, the rest keeps its bytes
+      std::array<uint8_t, sector_size> old  = {};
+      const size_t                     kept = m_random.below(sector_size);
+      static_cast<void>(m_file.read(sector * sector_size, old));
+      static_cast<void>(m_file.erase(sector));
+      static_cast<void>(m_file.write((sector + 1) * sector_size - kept,
+                                     std::span(old).last(kept)));
+      return false;
+    }
+    return m_file.erase(sector);
+  }
+
+private:
+  // Counts a write or an erase down, false once the power is cut
+  [[nodiscard]] bool is_powered() noexcept {
+    if (m_cut) {
+      return false;
+    }
+    if (m_left == 0 || (m_compaction && !m_counting)) {
+      return true;
+    }
+
+    m_cut = --m_left == 0;
+    if (m_cut && m_counting) {
+      ++m_cut_compactions;
+    }
+    m_counting = m_counting && !m_cut;
+    return !m_cut;
+  }
+
+  app::FileStorage& m_file;
+  app::Random       m_random;
+  uint32_t          m_left            = 0;
+  bool              m_compaction      = false;
+  bool              m_counting        = false;
+  bool              m_cut             = false;
+  uint32_t          m_cut_compactions = 0;
+};
+
+using ScoreLog = app::AppendLog<Score, CutStorage>;
+
+[[nodiscard]] bool is_ranked(const TopScores& top,
+                             const uint32_t   sequence) noexcept {
+  return std::ranges::any_of(top.items(), [sequence](const Ranked& ranked) {
+    return ranked.sequence == sequence;
+  });
+}
+
+/**
+ * @brief Rebuilds the top scores from the log like `leaderboard::init`.
+ */
+[[nodiscard]] bool load(ScoreLog& log, TopScores& top) noexcept {
+  top.clear();
+  return log.load([&top](const uint32_t sequence, const Score& score) {
+    if (!is_ranked(top, sequence)) {
+      top.insert({sequence, score});
+    }
+  });
+}
+
+void check_power_cuts() noexcept {
+  std::remove(path);
+  app::FileStorage file(path, sector_count);
+  CutStorage       storage(file);
+
+  app::Random random;
+  random.seed(42);
+
+  std::vector<Ranked> stored;
+  TopScores           top;
+  uint32_t            game    = 0;
+  uint32_t            cuts    = 0;
+  double              load_ns = 0;
+
+  for (uint32_t boot = 0; boot < boot_count; ++boot) {
+    storage.boot();
+    ScoreLog   log(storage);
+    const auto begin = std::chrono::steady_clock::now();
+    expect(load(log, top), "the log loads after every boot");
+    const std::chrono::duration<double, std::nano> elapsed =
+    std::chrono::steady_clock::now() - begin;
+    load_ns += elapsed.count();
+
+    TopScores expected;
+    for (const Ranked& ranked : stored) {
+      expected.insert(ranked);
+    }
+    expect(std::ranges::equal(top.items(),
+                              expected.items(),
+                              [](const Ranked& lhs, const Ranked& rhs) {
+                                return lhs.sequence == rhs.sequence;
+                              }),
+           "the rebuilt top scores are the best stored scores");
+
+    // The header, the copies and the erase of a compaction or any append
+    if (boot % 3 == 0) {
+      storage.cut_after(1 + random.below(games_per_boot), boot);
+      ++cuts;
+    } else if (boot % 3 == 1) {
+      storage.cut_in_compaction(
+      random.below(config::leaderboard::top_count + 2), boot);
+      ++cuts;
+    }
+
+    // Like `leaderboard::add_last_game`, ranked once the log stored it
+    for (uint32_t i = 0; i < games_per_boot || storage.is_armed(); ++i) {
+      const Score score = {game++,
+                           static_cast<uint16_t>(200 + random.below(600)),
+                           static_cast<uint8_t>(random.below(2)),
+                           static_cast<uint8_t>(1 + random.below(99))};
+
+      const uint32_t sequence = log.get_next_sequence();
+      if (!log.append(score, [&top](const uint32_t entry, const Score&) {
+            return is_ranked(top, entry);
+          })) {
+        break;
+      }
+      top.insert({sequence, score});
+      stored.push_back({sequence, score});
+    }
+  }
+
+  expect(storage.get_cut_compactions() > 0, "the power is cut in compactions");
+  std::printf("%zu scores stored over %lu boots, %lu power cuts, %lu in a "
+              "compaction, %.0f us per load of %zu sectors\n",
+              stored.size(),
+              static_cast<unsigned long>(boot_count),
+              static_cast<unsigned long>(cuts),
+              static_cast<unsigned long>(storage.get_cut_compactions()),
+              load_ns / boot_count / 1000,
+              sector_count);
+  std::remove(path);
+}
+
+}    // namespace
+
+int main() {
+  check_power_cuts();
+  return app::test::finish("score_log");
+}
@@ -0,0 +1,232 @@
+#include "app_game_core.hpp"
+#include "app_random.hpp"
+#include "config.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+// Games are cut short at a random frame and resumed from their snapshot in a
+// fresh state at an unrelated clock, like after a reset of the board. The
+// resumed game has to go on where the game stopped: same scores and targets,
+// the next hit moves on like it would have, the clock shows the time left and
+// the game ends when that time is up.
+
+namespace core = app::game::core;
+
+using app::test::expect;
+
+namespace {
+
+constexpr uint32_t game_count = 300;
+
+// The clock of the board after the reset
+constexpr int64_t resume_us = 700'000;
+
+static_assert(std::is_trivially_copyable_v<core::Snapshot>);
+
+struct Game {
+  core::GameState state;
+  core::Actions   actions;
+  int64_t         armed_us;
+};
+
+void arm(Game& game) noexcept {
+  for (const core::Action& action : game.actions) {
+    if (action.kind == core::ActionKind::ArmTimer) {
+      game.armed_us = action.time_us;
+    }
+  }
+}
+
+/**
+ * @brief Takes a snapshot through bytes, like the copy in RTC memory.
+ */
+[[nodiscard]] core::Snapshot save(const core::GameState& state,
+                                  const int64_t          now_us) noexcept {
+  const core::Snapshot taken = core::take_snapshot(state, now_us);
+
+  std::array<uint8_t, sizeof(core::Snapshot)> bytes = {};
+  std::memcpy(bytes.data(), &taken, sizeof(taken));
+
+  core::Snapshot restored = {};
+  std::memcpy(&restored, bytes.data(), sizeof(restored));
+  return restored;
+}
+
+[[nodiscard]] bool is_same_targets(const core::GameState& a,
+                                   const core::GameState& b) noexcept {
+  return a.scores == b.scores && a.target_indices == b.target_indices &&
+         a.target_masks == b.target_masks && a.decoy_masks == b.decoy_masks &&
+         a.cursors == b.cursors && a.target_leds == b.target_leds;
+}
+
+/**
+ * @brief Checks the game resumed from a snapshot of a running game.
+ */
+void check_resume(const core::GameState& state,
+                  const int64_t          now_us,
+                  Game&                  resumed) noexcept {
+  static core::GameState hit_state;
+  static core::GameState hit_resumed;
+  static core::Actions   actions;
+
+  resumed.actions.clear();
+  core::resume(resumed.state,
+               save(state, now_us),
+               resume_us,
+               *state.tables,
+               resumed.actions);
+
+  expect(!resumed.state.over && is_same_targets(resumed.state, state),
+         "a resumed game has the scores and targets of the snapshot");
+  expect(resumed.state.end_us - resume_us == state.end_us - now_us,
+         "a resumed game has the time that was left");
+
+  const core::Action& first = resumed.actions.items[0];
+  expect(resumed.actions.size > 0 &&
+         first.kind == core::ActionKind::ShowTime &&
+         first.value == (state.end_us - now_us) / core::tenth_us,
+         "a resumed game shows the time left first");
+
+  // A hit of a player moves on like it would have in the game
+  for (size_t player = 0; player < core::player_count; ++player) {
+    const uint8_t gpio_num =
+    config::stations::stations[player]
+    .buttons_in[state.target_indices[player]];
+
+    hit_state   = state;
+    hit_resumed = resumed.state;
+    actions.clear();
+    core::step(hit_state, {core::EventKind::Press, gpio_num, now_us}, actions);
+    core::step(hit_resumed,
+               {core::EventKind::Press, gpio_num, resume_us + 1},
+               actions);
+    expect(is_same_targets(hit_state, hit_resumed),
+           "a hit after the resume lights the next target of the game");
+  }
+
+  // Left alone, the game ends when its time is up, with the last clock tick
+  int64_t time_us    = resume_us;
+  int64_t last_tick  = 0;
+  size_t  step_count = 0;
+  while (!resumed.state.over && step_count++ < 100'000) {
+    time_us += 10'000;
+    resumed.actions.clear();
+    core::step(resumed.state,
+               {core::EventKind::Time, 0, time_us},
+               resumed.actions);
+    for (const core::Action& action : resumed.actions) {
+      if (action.kind == core::ActionKind::ShowTime) {
+        last_tick = action.time_us;
+      }
+    }
+  }
+  expect(resumed.state.over && last_tick == resumed.state.end_us,
+         "a resumed game ends when the time left is up");
+}
+
+/**
+ * @brief Plays a seeded game like the game loop and resumes it at a random
+ * frame.
+ */
+void play(const uint32_t seed) noexcept {
+  static core::TargetTables tables;
+  static Game               game;
+  static Game               resumed;
+
+  app::Random players;
+  players.seed(seed * 7 + 1);
+
+  core::TargetTimes times_us = {};
+  for (auto& player_times : times_us) {
+    for (uint32_t& time_us : player_times) {
+      time_us = players.below(800'000);
+    }
+  }
+  core::build_target_tables(times_us, tables);
+
+  app::Random random;
+  random.seed(seed);
+  const int64_t go_us = 5'000'000 + seed;
+
+  game.actions.clear();
+  core::start(game.state, go_us, random, tables, game.actions);
+  arm(game);
+
+  std::array<int64_t, core::player_count> press_us = {};
+  for (int64_t& due_us : press_us) {
+    due_us = go_us + 300'000 + players.below(500'000);
+  }
+
+  const uint32_t cut_frame = 1 + players.below(40);
+  for (uint32_t frame = 1; !game.state.over; ++frame) {
+    const int64_t now_us =
+    std::min(game.armed_us, *std::ranges::min_element(press_us)) +
+    players.below(300);
+
+    game.actions.clear();
+    for (size_t player = 0; player < core::player_count; ++player) {
+      while (press_us[player] <= now_us) {
+        const uint8_t target =
+        players.below(5) == 0
+        ? static_cast<uint8_t>(players.below(core::target_count))
+        : game.state.target_indices[player];
+        const core::Event press = {
+          core::EventKind::Press,
+          config::stations::stations[player].buttons_in[target],
+          press_us[player]};
+
+        core::step(game.state,
+                   {core::EventKind::Time, 0, press.time_us},
+                   game.actions);
+        core::step(game.state, press, game.actions);
+        press_us[player] += 200'000 + players.below(900'000);
+      }
+    }
+    core::step(game.state, {core::EventKind::Time, 0, now_us}, game.actions);
+    arm(game);
+
+    if (frame == cut_frame && !game.state.over) {
+      check_resume(game.state, now_us, resumed);
+    }
+  }
+}
+
+[[nodiscard]] double bench_resume() noexcept {
+  static core::TargetTables tables;
+  static Game               game;
+  core::build_target_tables({}, tables);
+
+  app::Random random;
+  random.seed(1);
+  game.actions.clear();
+  core::start(game.state, 0, random, tables, game.actions);
+  const core::Snapshot snapshot = save(game.state, 1'000'000);
+
+  constexpr size_t resumes = 100'000;
+  return app::test::measure_ns(resumes, [&] {
+    for (size_t i = 0; i < resumes; ++i) {
+      game.actions.clear();
+      core::resume(game.state, snapshot, resume_us, tables, game.actions);
+    }
+  });
+}
+
+}    // namespace
+
+int main() {
+  for (uint32_t seed = 1; seed <= game_count; ++seed) {
+    play(seed);
+  }
+
+  std::printf("Snapshot of %zu bytes, resumed in %.0f ns\n",
+              sizeof(core::Snapshot),
+              bench_resume());
+  return app::test::finish("snapshot");
+}
@@ -0,0 +1,113 @@
+#include "app_game_core.hpp"
+#include "app_random.hpp"
+#include "config.hpp"
+#include "test_check.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Pre-generated targets are lit in sequence order whatever the score does:
+// misses, decoys and expiries cost points but never walk a player back in
+// the sequence, so bags stay bags and shared sequences stay shared
+
+namespace core = app::game::core;
+
+using app::test::expect;
+
+namespace {
+
+[[nodiscard]] constexpr bool is_pre_generated() noexcept {
+  using config::game::TargetMode;
+  return config::game::target_mode != TargetMode::Live &&
+         config::game::target_mode != TargetMode::Adaptive;
+}
+
+/**
+ * @brief Plays a game with presses on lit and unlit buttons and pauses long
+ * enough for targets to expire.
+ *
+ * @return The targets each player was shown after the start and every
+ * completed set of targets.
+ */
+[[nodiscard]] std::vector<std::vector<uint8_t>>
+play(const uint32_t seed, core::GameState& state) noexcept {
+  static core::Actions      actions;
+  static core::TargetTables tables;
+  core::build_target_tables({}, tables);
+
+  app::Random random;
+  random.seed(seed);
+  app::Random players;
+  players.seed(~seed);
+
+  actions.clear();
+  core::start(state, 0, random, tables, actions);
+
+  std::vector<std::vector<uint8_t>> shown(core::player_count);
+  for (size_t player = 0; player < core::player_count; ++player) {
+    shown[player].push_back(state.target_indices[player]);
+  }
+
+  int64_t now_us = 0;
+  while (!state.over) {
+    const uint32_t pause_us = players.below(4) == 0 ? 3'000'000 : 400'000;
+    now_us                 += 50'000 + players.below(pause_us);
+    actions.clear();
+    core::step(state, {core::EventKind::Time, 0, now_us}, actions);
+    if (state.over) {
+      break;
+    }
+
+    const auto    player = static_cast<uint8_t>(players.below(2));
+    const uint8_t target = players.below(4) == 0
+                           ? static_cast<uint8_t>(players.below(8))
+                           : state.target_indices[player];
+
+    // The last lit target of a set moves the player on to the next entry
+    const bool    last  = std::popcount(state.target_masks[player]) == 1;
+    const uint8_t score = state.scores[player];
+    core::step(state,
+               {core::EventKind::Press,
+                config::stations::stations[player].buttons_in[target],
+                now_us},
+               actions);
+
+    if (last && state.scores[player] > score) {
+      shown[player].push_back(state.target_indices[player]);
+    }
+  }
+
+  return shown;
+}
+
+void check_sequences() noexcept {
+  static core::GameState state;
+
+  for (uint32_t seed = 1; seed <= 200; ++seed) {
+    const std::vector<std::vector<uint8_t>> shown = play(seed, state);
+
+    for (size_t player = 0; player < core::player_count; ++player) {
+      const core::TargetSequence& sequence = state.sequences[player];
+      for (size_t i = 0;
+           i < shown[player].size() && i < core::TargetSequence::length;
+           ++i) {
+        expect(shown[player][i] == sequence.at(i),
+               "every set lights the next entry of the sequence");
+      }
+    }
+  }
+}
+
+}    // namespace
+
+int main() {
+  if constexpr (!is_pre_generated()) {
+    std::printf("Targets are rolled, no sequence to check\n");
+  } else {
+    check_sequences();
+  }
+  return app::test::finish("target_sequence");
+}
@@ -0,0 +1,135 @@
+#include "app_random.hpp"
+#include "app_timer_wheel.hpp"
+#include "test_check.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// The timer wheel against a list of pending timers under random schedules,
+// cancels and advances, and the cost of the schedule, cancel and advance the
+// game does per hit
+
+using app::test::expect;
+
+namespace {
+
+constexpr int64_t tick_us  = 1000;
+constexpr size_t  capacity = 32;
+
+using Wheel = app::TimerWheel<capacity, tick_us>;
+
+[[nodiscard]] constexpr int64_t get_tick(const int64_t due_us) noexcept {
+  return (due_us + tick_us - 1) / tick_us;
+}
+
+struct Pending {
+  int64_t       due_us;
+  Wheel::Handle handle;
+  bool          live;
+};
+
+void check_against_list() noexcept {
+  app::Random random;
+  random.seed(7);
+
+  static Wheel wheel;
+  std::array<Pending, capacity * 2> timers = {};
+
+  int64_t now_us = 123'456'789;
+  wheel.reset(now_us);
+
+  size_t live  = 0;
+  size_t fired = 0;
+  for (int round = 0; round < 200'000; ++round) {
+    const uint32_t operation = random.below(10);
+    const uint32_t tag       = random.below(timers.size());
+    Pending&       timer     = timers[tag];
+
+    if (operation < 4 && !timer.live) {
+      // Near timers land in the lowest level, far ones up to the highest
+      const int64_t due_us =
+      now_us + (random.below(2) == 0 ? random.below(80'000)
+                                     : random.below(250'000'000));
+      const Wheel::Handle handle =
+      wheel.schedule(due_us, static_cast<uint8_t>(tag));
+      expect((handle == Wheel::no_timer) == (live == capacity),
+             "schedule fails only on a full wheel");
+      if (handle != Wheel::no_timer) {
+        timer = {due_us, handle, true};
+        ++live;
+      }
+    } else if (operation < 5 && timer.live) {
+      wheel.cancel(timer.handle);
+      timer.live = false;
+      --live;
+    } else if (operation >= 5) {
+      const int64_t next_us = wheel.next_due_us();
+      now_us += random.below(3) == 0 && next_us != Wheel::never
+                ? next_us - now_us
+                : random.below(20'000);
+
+      int64_t last_us = 0;
+      wheel.advance(now_us, [&](const uint8_t fired_tag, const int64_t due_us) {
+        Pending& expired = timers[fired_tag];
+        expect(expired.live && expired.due_us == due_us,
+               "only pending timers fire, with their due time");
+        expect(due_us <= now_us, "a timer never fires early");
+        // Timers of one tick fire in any order, one due on the tick the
+        // wheel stands on waits for the next
+        expect(get_tick(due_us) + 1 >= get_tick(last_us),
+               "timers fire in due order");
+        last_us      = due_us;
+        expired.live = false;
+        --live;
+        ++fired;
+      });
+
+      for (const Pending& pending : timers) {
+        expect(!pending.live || pending.due_us + tick_us > now_us,
+               "a timer fires at most one tick late");
+      }
+    }
+  }
+
+  expect(fired > 10'000, "the run fired timers");
+  std::printf("Fired %zu timers\n", fired);
+}
+
+/**
+ * @brief A hit moves the expiry of its player, the game loop then advances
+ * the wheel to the press.
+ */
+void bench_hit() noexcept {
+  constexpr size_t hits = 1'000'000;
+
+  static Wheel wheel;
+  size_t       fired  = 0;
+  const auto   per_op = app::test::measure_ns(hits, [&]() noexcept {
+    wheel.reset(0);
+    std::array<Wheel::Handle, 2> handles = {Wheel::no_timer, Wheel::no_timer};
+
+    int64_t now_us = 0;
+    for (size_t i = 0; i < hits; ++i) {
+      now_us += 150'000;
+      wheel.advance(now_us, [&fired](uint8_t, int64_t) noexcept { ++fired; });
+
+      Wheel::Handle& handle = handles[i % handles.size()];
+      wheel.cancel(handle);
+      handle = wheel.schedule(now_us + 2'000'000, static_cast<uint8_t>(i % 2));
+    }
+  });
+
+  std::printf("TimerWheel advance, cancel and schedule: %.2f ns (fired %zu)\n",
+              per_op,
+              fired);
+}
+
+}    // namespace
+
+int main() {
+  check_against_list();
+  bench_hit();
+  return app::test::finish("timer_wheel");
+}